@@ -0,0 +1,232 @@
+// Core benchmarks for vectorsketch_core; no OpenGL or GPU needed.
+// Covers smoothing, triangle strip generation, save/load, bulk import, lasso
+// selection and history operations over synthetic canvases of 1k to 1M strokes.
+//
+// Canvases come from a fixed seed and keep the same stroke density at every
+// size, so numbers are comparable across runs, machines and releases:
+//   ./build/vectorsketch_bench [max-strokes] [repeats]
+//
+// Each row reports the median and minimum wall time over `repeats` runs
+// (after one warm-up run) and the median time per stroke involved.
+
+#include "Canvas.h"
+#include "BezierSmoother.h"
+#include "Log.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace VectorSketch;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int POINTS_PER_STROKE = 16;
+constexpr float STROKE_SPACING = 100.0f;  // World units per stroke along each axis
+constexpr size_t HISTORY_STEPS = 1000;
+
+double elapsedMs(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Random-walk scribbles spread over a square whose area grows with the count
+void fillCanvas(Canvas& canvas, size_t strokeCount) {
+    std::mt19937 rng(20240611);
+    const float side = std::sqrt(static_cast<float>(strokeCount)) * STROKE_SPACING;
+    std::uniform_real_distribution<float> position(0.0f, side);
+    std::uniform_real_distribution<float> step(-8.0f, 8.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    for (size_t i = 0; i < strokeCount; ++i) {
+        canvas.beginStroke(glm::vec3(unit(rng), unit(rng), unit(rng)), 1.0f + unit(rng) * 7.0f);
+        glm::vec2 pos(position(rng), position(rng));
+        for (int p = 0; p < POINTS_PER_STROKE; ++p) {
+            canvas.addPointToCurrentStroke(StrokePoint(pos, 0.4f + unit(rng) * 0.6f, 0.0f, 0.0f, p * 0.008f));
+            pos += glm::vec2(step(rng), step(rng));
+        }
+        canvas.endStroke();
+    }
+}
+
+// Star-shaped lasso centred on the canvas, covering a few percent of it
+std::vector<glm::vec2> makeLasso(size_t strokeCount) {
+    const float side = std::sqrt(static_cast<float>(strokeCount)) * STROKE_SPACING;
+    const glm::vec2 center(side * 0.5f);
+    std::vector<glm::vec2> lasso;
+    for (int i = 0; i < 64; ++i) {
+        float angle = 6.2831853f * i / 64.0f;
+        float radius = side * ((i & 1) ? 0.08f : 0.15f);
+        lasso.push_back(center + radius * glm::vec2(std::cos(angle), std::sin(angle)));
+    }
+    return lasso;
+}
+
+struct Result {
+    double medianMs;
+    double minMs;
+};
+
+// `run` performs one repetition and returns the time it measured itself,
+// so per-repetition setup can stay outside the timed region
+Result measure(int repeats, const std::function<double()>& run) {
+    run();  // Warm-up
+    std::vector<double> times;
+    for (int i = 0; i < repeats; ++i) {
+        times.push_back(run());
+    }
+    std::sort(times.begin(), times.end());
+    return Result{times[times.size() / 2], times.front()};
+}
+
+void report(const char* name, size_t strokes, const Result& result, size_t items) {
+    std::printf("%-20s %10zu %14.3f %14.3f %14.1f\n", name, strokes, result.medianMs, result.minMs,
+                items ? result.medianMs * 1e6 / items : 0.0);
+    std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t maxStrokes = (argc > 1) ? std::max(1000L, std::atol(argv[1])) : 1000000;
+    const int repeats = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 5;
+    const std::string filepath = (std::filesystem::temp_directory_path() / "vectorsketch_bench.mm").string();
+
+    // Only warnings and errors while measuring: lower levels are not even formatted
+    Log::setLevel(Log::Level::Warn);
+
+    std::printf("%d points per stroke, %d repeats\n\n", POINTS_PER_STROKE, repeats);
+    std::printf("%-20s %10s %14s %14s %14s\n", "benchmark", "strokes", "median (ms)", "min (ms)", "ns/stroke");
+
+    for (size_t strokeCount = 1000; strokeCount <= maxStrokes; strokeCount *= 10) {
+        Canvas canvas;
+
+        auto buildStart = Clock::now();
+        fillCanvas(canvas, strokeCount);
+        double buildMs = elapsedMs(buildStart, Clock::now());
+        report("build", strokeCount, Result{buildMs, buildMs}, strokeCount);
+
+        const StrokePool& strokes = canvas.getStrokes();
+
+        report("smooth", strokeCount, measure(repeats, [&] {
+            size_t segments = 0;
+            auto start = Clock::now();
+            for (size_t i = 0; i < strokes.size(); ++i) {
+                segments += BezierSmoother::smooth(strokes.view(i)).size();
+            }
+            double ms = elapsedMs(start, Clock::now());
+            return segments ? ms : 0.0;
+        }), strokeCount);
+
+        // Only the strip call is timed; smoothing each stroke first is setup
+        auto stripBench = [&](bool adaptive) {
+            return measure(repeats, [&, adaptive] {
+                Clock::duration total{};
+                for (size_t i = 0; i < strokes.size(); ++i) {
+                    auto segments = BezierSmoother::smooth(strokes.view(i));
+                    auto start = Clock::now();
+                    auto vertices = adaptive
+                        ? BezierSmoother::generateTriangleStripAdaptive(segments, strokes.getBaseWidth(i), 1.0f)
+                        : BezierSmoother::generateTriangleStrip(segments, strokes.getBaseWidth(i), 15);
+                    total += Clock::now() - start;
+                    if (vertices.empty()) std::abort();
+                }
+                return std::chrono::duration<double, std::milli>(total).count();
+            });
+        };
+        report("strip_fixed", strokeCount, stripBench(false), strokeCount);
+        report("strip_adaptive", strokeCount, stripBench(true), strokeCount);
+
+        report("save", strokeCount, measure(repeats, [&] {
+            auto start = Clock::now();
+            if (!canvas.saveToFile(filepath)) std::abort();
+            return elapsedMs(start, Clock::now());
+        }), strokeCount);
+
+        report("load", strokeCount, measure(repeats, [&] {
+            Canvas loaded;
+            auto start = Clock::now();
+            if (!loaded.loadFromFile(filepath)) std::abort();
+            return elapsedMs(start, Clock::now());
+        }), strokeCount);
+
+        // The canvas packed as addon addStrokes arguments: appendPacked plus
+        // the single-command append are timed, packing is setup
+        {
+            const StrokePointArrays& points = strokes.getPointArrays();
+            const size_t pointCount = points.size();
+            std::vector<float> packed(pointCount * 6);
+            for (size_t p = 0; p < pointCount; ++p) {
+                float* point = &packed[p * 6];
+                point[0] = points.x[p];
+                point[1] = points.y[p];
+                point[2] = points.pressure[p];
+                point[3] = points.tiltX[p];
+                point[4] = points.tiltY[p];
+                point[5] = points.timestamp[p];
+            }
+            std::vector<float> colors;
+            for (const glm::vec3& color : strokes.getColors()) {
+                colors.insert(colors.end(), {color.r, color.g, color.b});
+            }
+            report("add_strokes", strokeCount, measure(repeats, [&] {
+                Canvas imported;
+                auto start = Clock::now();
+                StrokePool added;
+                added.appendPacked(packed.data(), 6, strokes.getOffsets().data(), strokes.size(), colors.data(),
+                                   strokes.getBaseWidths().data());
+                imported.addStrokes(added);
+                double ms = elapsedMs(start, Clock::now());
+                if (imported.getStrokes().size() != strokeCount) std::abort();
+                return ms;
+            }), strokeCount);
+        }
+
+        const std::vector<glm::vec2> lasso = makeLasso(strokeCount);
+        report("lasso", strokeCount, measure(repeats, [&] {
+            auto start = Clock::now();
+            canvas.selectStrokesInPolygon(lasso);
+            return elapsedMs(start, Clock::now());
+        }), strokeCount);
+        size_t selected = canvas.getSelectedStrokes().size();
+
+        // One drag of the lasso selection, then its undo
+        report("move_undo", strokeCount, measure(repeats, [&] {
+            auto start = Clock::now();
+            for (int step = 0; step < 10; ++step) {
+                canvas.moveSelectedStrokes(glm::vec2(1.0f, -1.0f));
+            }
+            canvas.finishMovingSelection();
+            canvas.undo();
+            return elapsedMs(start, Clock::now());
+        }), selected);
+        canvas.clearSelection();
+
+        // Undo and redo the most recent strokes, one command at a time
+        const size_t steps = std::min(HISTORY_STEPS, strokeCount);
+        report("undo_redo", strokeCount, measure(repeats, [&] {
+            auto start = Clock::now();
+            for (size_t i = 0; i < steps && canvas.canUndo(); ++i) canvas.undo();
+            while (canvas.canRedo()) canvas.redo();
+            return elapsedMs(start, Clock::now());
+        }), steps * 2);
+
+        report("clear_undo", strokeCount, measure(repeats, [&] {
+            auto start = Clock::now();
+            canvas.clear();
+            canvas.undo();
+            return elapsedMs(start, Clock::now());
+        }), strokeCount);
+    }
+
+    Log::flush();
+    std::filesystem::remove(filepath);
+    return 0;
+}
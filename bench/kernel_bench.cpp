@@ -0,0 +1,199 @@
+// Array-of-structs vs. structure-of-arrays benchmark for the stroke hot loops.
+// The AoS versions are the loops the canvas used on std::vector<StrokePoint>
+// (movePoints, bounds, lasso point-in-polygon, Catmull-Rom control points);
+// the SoA versions are StrokeKernels on separate x/y arrays.
+//
+// Build in Release (the default) so the kernels are vectorized:
+//   ./build/VectorSketchKernelBench [points] [iterations]
+
+#include "StrokeKernels.h"
+#include "StrokePoint.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace VectorSketch;
+
+namespace {
+
+// Reference AoS loops
+
+void translateAoS(std::vector<StrokePoint>& points, const glm::vec2& delta) {
+    for (auto& point : points) {
+        point.position += delta;
+    }
+}
+
+BoundingBox boundsAoS(const std::vector<StrokePoint>& points) {
+    BoundingBox bounds;
+    for (const auto& point : points) {
+        bounds.expand(point.position);
+    }
+    return bounds;
+}
+
+bool pointInPolygonAoS(const glm::vec2& point, const std::vector<glm::vec2>& polygon) {
+    bool inside = false;
+    size_t j = polygon.size() - 1;
+    for (size_t i = 0; i < polygon.size(); i++) {
+        if ((polygon[i].y > point.y) != (polygon[j].y > point.y) &&
+            (point.x < (polygon[j].x - polygon[i].x) * (point.y - polygon[i].y) /
+                       (polygon[j].y - polygon[i].y) + polygon[i].x)) {
+            inside = !inside;
+        }
+        j = i;
+    }
+    return inside;
+}
+
+void controlPointsAoS(const std::vector<StrokePoint>& points, float tension,
+                      std::vector<glm::vec2>& c1, std::vector<glm::vec2>& c2) {
+    for (size_t i = 0; i + 1 < points.size(); ++i) {
+        const glm::vec2& p0 = points[i].position;
+        const glm::vec2& p1 = points[i + 1].position;
+        glm::vec2 prevPos = (i > 0) ? points[i - 1].position : p0;
+        glm::vec2 nextPos = (i + 2 < points.size()) ? points[i + 2].position : p1;
+        c1[i] = p0 + ((p1 - prevPos) * tension) / 3.0f;
+        c2[i] = p1 - ((nextPos - p0) * tension) / 3.0f;
+    }
+}
+
+template <typename Fn>
+double timeMs(int iterations, Fn&& fn) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+void report(const char* name, double aosMs, double soaMs, bool match) {
+    std::printf("%-22s %12.3f %12.3f %9.2fx  %s\n", name, aosMs, soaMs, aosMs / soaMs,
+                match ? "ok" : "MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = (argc > 1) ? std::max(16L, std::atol(argv[1])) : 1 << 20;
+    const int iterations = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 20;
+    
+    // One long random walk, laid out both ways
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> step(-3.0f, 3.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    
+    std::vector<StrokePoint> aos;
+    StrokePointArrays soa;
+    aos.reserve(count);
+    soa.reserve(count);
+    glm::vec2 pos(500.0f, 500.0f);
+    for (size_t i = 0; i < count; ++i) {
+        StrokePoint point(pos, unit(rng), unit(rng), unit(rng), i * 0.004f);
+        aos.push_back(point);
+        soa.push_back(point);
+        pos += glm::vec2(step(rng), step(rng));
+    }
+    
+    // Hand-drawn-looking lasso: a wobbly circle
+    std::vector<glm::vec2> lasso;
+    for (int i = 0; i < 96; ++i) {
+        float angle = 6.2831853f * i / 96.0f;
+        float radius = 400.0f + 40.0f * std::sin(angle * 7.0f);
+        lasso.push_back(glm::vec2(500.0f) + radius * glm::vec2(std::cos(angle), std::sin(angle)));
+    }
+    
+    std::printf("%zu points, %d iterations, %zu-vertex lasso\n\n", count, iterations, lasso.size());
+    std::printf("%-22s %12s %12s %10s\n", "kernel", "AoS (ms)", "SoA (ms)", "speedup");
+    
+    // Translate (alternating sign so coordinates do not drift)
+    {
+        int flip = 0;
+        double aosMs = timeMs(iterations, [&] {
+            translateAoS(aos, glm::vec2((flip++ & 1) ? -1.5f : 1.5f, 0.25f));
+        });
+        flip = 0;
+        double soaMs = timeMs(iterations, [&] {
+            StrokeKernels::translate(soa.x.data(), soa.y.data(), soa.size(),
+                                     glm::vec2((flip++ & 1) ? -1.5f : 1.5f, 0.25f));
+        });
+        bool match = aos.back().position == glm::vec2(soa.x.back(), soa.y.back());
+        report("translate", aosMs, soaMs, match);
+    }
+    
+    // Bounding box
+    {
+        BoundingBox a, b;
+        double aosMs = timeMs(iterations, [&] { a = boundsAoS(aos); });
+        double soaMs = timeMs(iterations, [&] { b = StrokeKernels::computeBounds(soa.x.data(), soa.y.data(), soa.size()); });
+        report("bounding box", aosMs, soaMs, a.min == b.min && a.max == b.max);
+    }
+    
+    // Lasso: "does any point of this stroke fall inside?" for strokes of 64
+    // points, with the bounds pre-check the canvas always did. One lasso is a
+    // small wobbly circle, the other a 24-point star spanning the whole walk.
+    {
+        BoundingBox walkBounds = boundsAoS(aos);
+        glm::vec2 center = (walkBounds.min + walkBounds.max) * 0.5f;
+        float extent = glm::length(walkBounds.max - walkBounds.min) * 0.5f;
+        std::vector<glm::vec2> star;
+        for (int i = 0; i < 48; ++i) {
+            float angle = 6.2831853f * i / 48.0f;
+            float radius = (i & 1) ? extent * 0.3f : extent;
+            star.push_back(center + radius * glm::vec2(std::cos(angle), std::sin(angle)));
+        }
+        
+        const size_t strokeLength = 64;
+        for (const auto* polygon : {&lasso, &star}) {
+            BoundingBox polygonBounds;
+            for (const auto& vertex : *polygon) {
+                polygonBounds.expand(vertex);
+            }
+            
+            size_t aosHits = 0, soaHits = 0;
+            double aosMs = timeMs(iterations, [&] {
+                aosHits = 0;
+                for (size_t start = 0; start < count; start += strokeLength) {
+                    size_t end = std::min(count, start + strokeLength);
+                    for (size_t i = start; i < end; ++i) {
+                        if (polygonBounds.contains(aos[i].position) && pointInPolygonAoS(aos[i].position, *polygon)) {
+                            aosHits++;
+                            break;
+                        }
+                    }
+                }
+            });
+            double soaMs = timeMs(iterations, [&] {
+                soaHits = 0;
+                for (size_t start = 0; start < count; start += strokeLength) {
+                    size_t n = std::min(strokeLength, count - start);
+                    soaHits += StrokeKernels::anyPointInPolygon(soa.x.data() + start, soa.y.data() + start, n, *polygon) ? 1 : 0;
+                }
+            });
+            report(polygon == &lasso ? "lasso (circle)" : "lasso (star)", aosMs, soaMs, aosHits == soaHits);
+        }
+    }
+    
+    // Catmull-Rom control points
+    {
+        std::vector<glm::vec2> c1(count - 1), c2(count - 1);
+        std::vector<float> c1x(count - 1), c1y(count - 1), c2x(count - 1), c2y(count - 1);
+        double aosMs = timeMs(iterations, [&] { controlPointsAoS(aos, 0.5f, c1, c2); });
+        double soaMs = timeMs(iterations, [&] {
+            StrokeKernels::catmullRomControlPoints(soa.x.data(), soa.y.data(), soa.size(), 0.5f,
+                                                   c1x.data(), c1y.data(), c2x.data(), c2y.data());
+        });
+        bool match = true;
+        for (size_t i = 0; i + 1 < count && match; ++i) {
+            match = c1[i] == glm::vec2(c1x[i], c1y[i]) && c2[i] == glm::vec2(c2x[i], c2y[i]);
+        }
+        report("catmull-rom controls", aosMs, soaMs, match);
+    }
+    
+    return 0;
+}
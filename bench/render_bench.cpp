@@ -0,0 +1,235 @@
+// Stroke-count vs. frame-time benchmark for VectorRenderer
+// Compares RenderMode::PerStroke (one draw call per stroke) with
+// RenderMode::Batched (one glMultiDrawArrays per frame), with
+// RenderMode::GpuExpanded (segments uploaded, strips built by the vertex
+// shader) and with the composited mode, where the committed strokes come
+// from the cached static layer. Every frame also extends a live stroke, as
+// while drawing. The upload column is the geometry sent by the first frame.
+//
+// A second table compares the antialiasing modes on wide, overlapping
+// strokes (fill-rate bound): a 4x multisampled window with
+// Antialiasing::Multisample against a single-sample one with
+// Antialiasing::Analytic, plus a single-sample window without any
+// antialiasing as the floor.
+//
+// Needs an OpenGL 3.3 context; runs headless under Xvfb with Mesa llvmpipe:
+//   xvfb-run ./build/VectorSketchRenderBench [frames]
+
+#include "VectorRenderer.h"
+#include "Stroke.h"
+#include "Log.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace VectorSketch;
+
+static std::vector<Stroke> makeStrokes(size_t count, int width, int height) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> posX(0.0f, static_cast<float>(width));
+    std::uniform_real_distribution<float> posY(0.0f, static_cast<float>(height));
+    std::uniform_real_distribution<float> step(-6.0f, 6.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    
+    std::vector<Stroke> strokes(count);
+    for (auto& stroke : strokes) {
+        stroke.setColor(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        stroke.setBaseWidth(2.0f + unit(rng) * 6.0f);
+        
+        // Short random walk, similar to a quick hand-drawn scribble
+        glm::vec2 pos(posX(rng), posY(rng));
+        for (int i = 0; i < 24; ++i) {
+            stroke.addPoint(StrokePoint(pos, 0.5f + unit(rng) * 0.5f));
+            pos += glm::vec2(step(rng), step(rng));
+        }
+    }
+    return strokes;
+}
+
+// Fewer, wider strokes: every pixel of the window is covered several times
+static std::vector<Stroke> makeWideStrokes(size_t count, int width, int height) {
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> posX(0.0f, static_cast<float>(width));
+    std::uniform_real_distribution<float> posY(0.0f, static_cast<float>(height));
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    
+    std::vector<Stroke> strokes(count);
+    for (auto& stroke : strokes) {
+        stroke.setColor(glm::vec3(unit(rng), unit(rng), unit(rng)));
+        stroke.setBaseWidth(20.0f + unit(rng) * 40.0f);
+        
+        glm::vec2 pos(posX(rng), posY(rng));
+        float angle = unit(rng) * 6.2831853f;
+        for (int i = 0; i < 24; ++i) {
+            stroke.addPoint(StrokePoint(pos, 0.8f));
+            angle += (unit(rng) - 0.5f) * 0.6f;
+            pos += glm::vec2(std::cos(angle), std::sin(angle)) * 12.0f;
+        }
+    }
+    return strokes;
+}
+
+static double renderFrame(VectorRenderer& renderer, const std::vector<Stroke>& strokes, Stroke& live) {
+    auto start = std::chrono::high_resolution_clock::now();
+    
+    renderer.beginFrame();
+    if (renderer.beginStaticLayer(1)) {
+        for (const auto& stroke : strokes) {
+            renderer.submitStroke(stroke);
+        }
+        renderer.flushBatch();
+    }
+    renderer.endStaticLayer();
+    
+    // One new point per frame
+    size_t n = live.getPointCount();
+    live.addPoint(StrokePoint(glm::vec2(100.0f + n * 2.0f, 300.0f + std::sin(n * 0.1f) * 40.0f), 0.8f));
+    renderer.renderLiveStroke(live);
+    
+    renderer.endFrame();
+    glFinish();
+    
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int frames = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 50;
+    const int width = 1280;
+    const int height = 720;
+    
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return 1;
+    }
+    
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    
+    GLFWwindow* window = glfwCreateWindow(width, height, "VectorSketch Render Bench", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    
+    VectorRenderer renderer;
+    if (!renderer.initialize(width, height)) {
+        glfwTerminate();
+        return 1;
+    }
+    
+    // Only warnings and errors while measuring: lower levels are not even formatted
+    Log::setLevel(Log::Level::Warn);
+    
+    const size_t strokeCounts[] = {100, 1000, 5000, 10000, 25000};
+    
+    std::printf("%-10s %-12s %14s %14s %12s %14s\n", "strokes", "mode", "build (ms)", "frame (ms)", "draw calls",
+                "upload (KB)");
+    for (size_t count : strokeCounts) {
+        auto strokes = makeStrokes(count, width, height);
+        
+        for (int variant = 0; variant < 4; ++variant) {
+            const bool composited = (variant == 3);
+            const RenderMode modes[] = {RenderMode::PerStroke, RenderMode::Batched, RenderMode::GpuExpanded,
+                                        RenderMode::Batched};
+            const RenderMode mode = modes[variant];
+            renderer.clearGeometryCache();
+            renderer.setRenderMode(mode);
+            renderer.setCompositing(composited);
+            
+            Stroke live;
+            live.setBaseWidth(4.0f);
+            
+            // First frame tessellates and uploads everything
+            const uint64_t uploadedBefore = renderer.getUploadedBytes();
+            double buildMs = renderFrame(renderer, strokes, live);
+            const double uploadKb = (renderer.getUploadedBytes() - uploadedBefore) / 1024.0;
+            
+            double totalMs = 0.0;
+            for (int f = 0; f < frames; ++f) {
+                totalMs += renderFrame(renderer, strokes, live);
+            }
+            
+            const char* names[] = {"per-stroke", "batched", "gpu-expanded", "composited"};
+            size_t drawCalls[] = {count + 1, 2, 2, 2};
+            std::printf("%-10zu %-12s %14.2f %14.3f %12zu %14.1f\n", count, names[variant],
+                        buildMs, totalMs / frames, drawCalls[variant], uploadKb);
+            std::fflush(stdout);
+        }
+    }
+    
+    glfwDestroyWindow(window);
+    
+    // Antialiasing: the sample count is fixed when the window is created,
+    // so every mode gets its own window and renderer
+    struct AntialiasingVariant {
+        const char* name;
+        int samples;
+        Antialiasing antialiasing;
+        RenderMode mode;
+    };
+    const AntialiasingVariant variants[] = {
+        {"msaa-4x", 4, Antialiasing::Multisample, RenderMode::Batched},
+        {"msaa-4x-gpu", 4, Antialiasing::Multisample, RenderMode::GpuExpanded},
+        {"analytic-1x", 0, Antialiasing::Analytic, RenderMode::GpuExpanded},
+        {"aliased-1x", 0, Antialiasing::Multisample, RenderMode::GpuExpanded},
+    };
+    
+    const size_t wideStrokeCounts[] = {1000, 5000};
+    
+    std::printf("\n%-10s %-12s %8s %14s\n", "strokes", "antialias", "samples", "frame (ms)");
+    for (size_t count : wideStrokeCounts) {
+        auto strokes = makeWideStrokes(count, width, height);
+        
+        for (const auto& variant : variants) {
+            glfwWindowHint(GLFW_SAMPLES, variant.samples);
+            GLFWwindow* aaWindow = glfwCreateWindow(width, height, "VectorSketch Render Bench", nullptr, nullptr);
+            if (!aaWindow) {
+                std::printf("%-10zu %-12s %8d %14s\n", count, variant.name, variant.samples, "no window");
+                continue;
+            }
+            glfwMakeContextCurrent(aaWindow);
+            glfwSwapInterval(0);
+            
+            {
+                VectorRenderer aaRenderer;
+                if (aaRenderer.initialize(width, height, variant.antialiasing)) {
+                    aaRenderer.setRenderMode(variant.mode);
+                    aaRenderer.setCompositing(false);
+                    aaRenderer.setTileCaching(false);
+                    
+                    Stroke live;
+                    live.setBaseWidth(40.0f);
+                    renderFrame(aaRenderer, strokes, live);
+                    
+                    double totalMs = 0.0;
+                    for (int f = 0; f < frames; ++f) {
+                        totalMs += renderFrame(aaRenderer, strokes, live);
+                    }
+                    std::printf("%-10zu %-12s %8d %14.3f\n", count, variant.name, variant.samples, totalMs / frames);
+                    std::fflush(stdout);
+                }
+            }
+            glfwDestroyWindow(aaWindow);
+        }
+    }
+    
+    Log::flush();
+    
+    glfwTerminate();
+    return 0;
+}
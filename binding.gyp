@@ -4,8 +4,14 @@
       "target_name": "infinitecanvas",
       "sources": [
         "src/node_addon.cpp",
+        "src/Log.cpp",
         "src/Canvas.cpp",
+        "src/CanvasRender.cpp",
+        "src/SpatialIndex.cpp",
         "src/Stroke.cpp",
+        "src/StrokePool.cpp",
+        "src/StrokeKernels.cpp",
+        "src/MappedFile.cpp",
         "src/BezierSmoother.cpp",
         "src/VectorRenderer.cpp",
         "src/ToolWheel.cpp",
@@ -91,7 +91,7 @@ ipcMain.handle('save-drawing', async () => {
       return { success: false, canceled: true };
     }
     
-    const success = canvas.saveDrawing(result.filePath);
+    const success = await canvas.saveDrawingAsync(result.filePath);
     return { 
       success, 
       filePath: result.filePath,
@@ -120,7 +120,7 @@ ipcMain.handle('load-drawing', async () => {
       return { success: false, canceled: true };
     }
     
-    const success = canvas.loadDrawing(result.filePaths[0]);
+    const success = await canvas.loadDrawingAsync(result.filePaths[0]);
     return { 
       success, 
       filePath: result.filePaths[0],
@@ -136,7 +136,7 @@ ipcMain.handle('load-drawing', async () => {
  */
 ipcMain.handle('clear-canvas', async () => {
   try {
-    const success = canvas.clear();
+    const success = await canvas.clear();
     return { success, message: 'Canvas cleared' };
   } catch (error) {
     return { success: false, error: error.message };
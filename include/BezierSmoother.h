@@ -19,8 +19,26 @@ struct BezierSegment {
 // Smooths stroke points into Bézier curves
 class BezierSmoother {
 public:
-    // Convert raw stroke points into smooth Bézier segments
-    static std::vector<BezierSegment> smooth(const Stroke& stroke, float tension = 0.5f);
+    // Convert raw stroke points into smooth Bézier segments (one per point
+    // pair); StrokeEncoding::Cubic strokes give back their stored curves
+    static std::vector<BezierSegment> smooth(const StrokeView& stroke, float tension = 0.5f);
+    
+    // Fit as few cubic curves as possible through the points of a sampled
+    // stroke (Schneider's recursive least-squares fitting), keeping every
+    // point within `tolerance` world units of the curves and its half width
+    // within `tolerance` of the width interpolated along them. Returns the
+    // control points for StrokeEncoding::Cubic: p0 c1 c2 p1 c1 c2 p2 ...;
+    // knots carry the pressure, tilt and time of the point they sit on,
+    // inner control points interpolate them. Empty for fewer than two
+    // distinct positions.
+    static std::vector<StrokePoint> fitCubics(const StrokeView& stroke, float tolerance);
+    
+    // Bring `segments` (from an earlier smooth() of the same stroke) up to
+    // date after points were appended or the last point was replaced. Only
+    // the old last two segments and the new ones are recomputed; returns the
+    // index of the first changed segment (0 when everything was rebuilt).
+    static size_t smoothIncremental(const Stroke& stroke, std::vector<BezierSegment>& segments,
+                                    float tension = 0.5f);
     
     // Evaluate a Bézier curve at parameter t (0 to 1)
     static glm::vec2 evaluateCubic(const BezierSegment& segment, float t);
@@ -34,6 +52,41 @@ public:
     static std::vector<glm::vec2> generateTriangleStrip(const std::vector<BezierSegment>& segments,
                                                          float baseWidth,
                                                          int pointsPerSegment = 20);
+    
+    // Same strip, but sample counts follow a screen-space error bound: each
+    // segment gets just enough points that neither the centerline nor the
+    // outline deviates more than `tolerance` pixels at `pixelsPerUnit` zoom,
+    // and caps/dots are sized from their on-screen radius
+    static std::vector<glm::vec2> generateTriangleStripAdaptive(const std::vector<BezierSegment>& segments,
+                                                                 float baseWidth,
+                                                                 float pixelsPerUnit,
+                                                                 float tolerance = 0.25f);
+    
+    // Centerline samples (including both endpoints) needed for one segment
+    static int segmentSampleCount(const BezierSegment& segment, float halfWidth,
+                                  float pixelsPerUnit, float tolerance);
+    
+    // Segments needed for a full circle of the given on-screen radius
+    static int circleSegmentCount(float radiusPixels, float tolerance);
+    
+    // Unit normal of the centerline at sample i (from its neighbours)
+    static glm::vec2 centerlineNormal(const std::vector<glm::vec2>& centerPoints, size_t i);
+    
+    // Circle as (center, edge) strip pairs; used for dots and round caps
+    static void appendCircle(std::vector<glm::vec2>& vertices, const glm::vec2& center,
+                             float radius, int circleSegments);
+    
+private:
+    static constexpr int MAX_ADAPTIVE_SAMPLES = 64;
+    static constexpr int MIN_CIRCLE_SEGMENTS = 6;
+    static constexpr int MAX_CIRCLE_SEGMENTS = 64;
+    
+    // Strip layout shared by both modes: start cap, body, end cap
+    static std::vector<glm::vec2> buildStrip(const std::vector<glm::vec2>& centerPoints,
+                                             float halfWidth,
+                                             int capSegments,
+                                             int dotSegments);
+    static BezierSegment catmullRomSegment(const StrokeView& stroke, size_t i, float tension);
 };
 
 } // namespace VectorSketch
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <limits>
+
+namespace VectorSketch {
+
+// Axis-aligned bounding box in world space (empty until a point is added)
+struct BoundingBox {
+    glm::vec2 min{std::numeric_limits<float>::max()};
+    glm::vec2 max{-std::numeric_limits<float>::max()};
+    
+    BoundingBox() = default;
+    BoundingBox(const glm::vec2& minCorner, const glm::vec2& maxCorner)
+        : min(minCorner), max(maxCorner) {}
+    
+    bool isEmpty() const { return min.x > max.x || min.y > max.y; }
+    
+    // False for NaN or infinite corners, which no query or growth can handle
+    bool isFinite() const {
+        return std::isfinite(min.x) && std::isfinite(min.y) && std::isfinite(max.x) && std::isfinite(max.y);
+    }
+    
+    void expand(const glm::vec2& point) {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+    
+    void expand(const BoundingBox& other) {
+        if (other.isEmpty()) return;
+        min = glm::min(min, other.min);
+        max = glm::max(max, other.max);
+    }
+    
+    void translate(const glm::vec2& delta) {
+        if (isEmpty()) return;
+        min += delta;
+        max += delta;
+    }
+    
+    // Grow by margin on every side (e.g. half the stroke width)
+    BoundingBox inflated(float margin) const {
+        if (isEmpty()) return *this;
+        return BoundingBox(min - glm::vec2(margin), max + glm::vec2(margin));
+    }
+    
+    bool intersects(const BoundingBox& other) const {
+        return !isEmpty() && !other.isEmpty() &&
+               min.x <= other.max.x && max.x >= other.min.x &&
+               min.y <= other.max.y && max.y >= other.min.y;
+    }
+    
+    bool contains(const glm::vec2& point) const {
+        return point.x >= min.x && point.x <= max.x &&
+               point.y >= min.y && point.y <= max.y;
+    }
+    
+    bool contains(const BoundingBox& other) const {
+        return !other.isEmpty() &&
+               other.min.x >= min.x && other.max.x <= max.x &&
+               other.min.y >= min.y && other.max.y <= max.y;
+    }
+};
+
+} // namespace VectorSketch
@@ -1,21 +1,27 @@
 #pragma once
 
 #include "Stroke.h"
-#include "VectorRenderer.h"
+#include "StrokePool.h"
+#include "SpatialIndex.h"
 #include <vector>
+#include <deque>
 #include <memory>
 #include <string>
 #include <set>
+#include <functional>
 
 namespace VectorSketch {
 
+class VectorRenderer;
+
 // Infinite canvas that manages all strokes
 class Canvas {
 public:
     Canvas() = default;
     
-    // Start a new stroke
-    void beginStroke(const glm::vec3& color = glm::vec3(0.0f, 0.0f, 0.0f), float width = 2.0f);
+    // Start a new stroke; points added to it go through `filter` (world units)
+    void beginStroke(const glm::vec3& color = glm::vec3(0.0f, 0.0f, 0.0f), float width = 2.0f,
+                     const StrokeInputFilter& filter = StrokeInputFilter());
     
     // Add point to current stroke
     void addPointToCurrentStroke(const StrokePoint& point);
@@ -26,48 +32,122 @@ public:
     // Clear all strokes
     void clear();
     
+    // Move every stroke of `added` onto the canvas as one undo step (bulk
+    // imports and replays); the pool is left empty
+    void addStrokes(StrokePool& added);
+    
     // Undo/Redo operations
     void undo();
     void redo();
-    bool canUndo() const { return !history.empty() && historyIndex > 0; }
-    bool canRedo() const { return !history.empty() && historyIndex < history.size() - 1; }
+    bool canUndo() const { return historyIndex > 0; }
+    bool canRedo() const { return historyIndex < history.size(); }
     
-    // Render all strokes
+    // History depth is bounded by the bytes the undo log keeps alive
+    void setHistoryMemoryBudget(size_t bytes);
+    size_t getHistoryMemoryBudget() const { return historyBudget; }
+    size_t getHistoryMemoryUsage() const { return historyBytes; }
+    
+    // Render all strokes (CanvasRender.cpp; not part of the GL-free core).
+    // Only the area damaged since the last call is redrawn into the
+    // renderer's static layer
     void render(VectorRenderer& renderer);
     
+    // Something visible changed since the last render(): committed strokes,
+    // the stroke being drawn or the selection
+    bool needsRedraw() const { return dirty; }
+    
     // Get stroke count
     size_t getStrokeCount() const { return strokes.size(); }
     
+    // Committed strokes, read-only
+    const StrokePool& getStrokes() const { return strokes; }
+    
     bool isDrawing() const { return currentStroke != nullptr; }
     
     // File operations
     bool saveToFile(const std::string& filepath);
     bool loadFromFile(const std::string& filepath);
     
+    // Called with the fraction of a file written or read so far, at most
+    // once per percent, on the thread doing the I/O
+    using FileProgress = std::function<void(float)>;
+    
+    // The halves of saveToFile/loadFromFile, for callers that do the file
+    // I/O away from the thread that owns the canvas: write a pool, or read
+    // one into an empty pool, without touching any canvas; then swap the
+    // read strokes in (undoable, like a load)
+    static bool writeStrokes(const StrokePool& strokes, const std::string& filepath,
+                             const FileProgress& progress = nullptr);
+    static bool readStrokes(const std::string& filepath, StrokePool& loaded,
+                            const FileProgress& progress = nullptr);
+    void replaceStrokes(StrokePool& loaded);
+    
     // Selection system
     void selectStrokesInPolygon(const std::vector<glm::vec2>& lassoPoints);
     void clearSelection();
     void moveSelectedStrokes(const glm::vec2& delta);
+    void finishMovingSelection();  // Ends the current drag; later moves start a new undo step
     bool hasSelection() const { return !selectedStrokes.empty(); }
     const std::set<size_t>& getSelectedStrokes() const { return selectedStrokes; }
     
+    // Spatial queries (indices in paint order, bottom to top)
+    std::vector<size_t> queryStrokes(const BoundingBox& area) const;
+    
+    // Topmost stroke whose outline passes within tolerance of worldPos
+    bool hitTest(const glm::vec2& worldPos, float tolerance, size_t& strokeIndex) const;
+    
 private:
-    void saveToHistory();
-    void loadFromHistory(size_t index);
+    enum class CommandType {
+        AddStroke,      // The last stroke moves between the canvas and the command
+        AddStrokes,     // The last `count` strokes do, in bulk
+        Clear,          // The whole canvas is swapped with the command's pool
+        MoveSelection,  // indices are translated by delta
+        Load            // Same swap as Clear, with the loaded file on the other side
+    };
+    
+    // One undoable edit, storing only what it changed
+    struct Command {
+        CommandType type;
+        StrokePool strokes;  // Whatever this command currently holds off the canvas
+        std::vector<size_t> indices;
+        glm::vec2 delta = glm::vec2(0.0f);
+        size_t count = 0;
+        bool open = false;  // MoveSelection still accumulating drag deltas
+        size_t bytes = 0;
+    };
+    
+    void pushCommand(Command command);
+    void applyCommand(Command& command);
+    void revertCommand(Command& command);
+    void swapStrokes(StrokePool& other);
+    void trimHistory();
+    static size_t commandBytes(const Command& command);
+    void rebuildSpatialIndex();
+    void addDamage(const BoundingBox& area);
+    void addFullDamage();
     
-    std::vector<std::shared_ptr<Stroke>> strokes;
+    // Committed strokes; currentStroke is only the one being drawn
+    StrokePool strokes;
     std::shared_ptr<Stroke> currentStroke;
     
     // Selection system
     std::set<size_t> selectedStrokes; // Indices of selected strokes
     
-    // History for undo/redo (max 7 states)
-    static constexpr size_t MAX_HISTORY = 7;
-    std::vector<std::vector<std::shared_ptr<Stroke>>> history;
-    size_t historyIndex = 0;
+    // Quadtree over stroke bounds, keyed by index into strokes
+    SpatialIndex spatialIndex;
+    
+    // Changes since the last render(). damage is the world area where
+    // committed strokes changed; fullDamage when that area is everything.
+    bool dirty = true;
+    bool fullDamage = true;
+    BoundingBox damage;
     
-    // Helper: Check if point is inside polygon (for lasso)
-    bool pointInPolygon(const glm::vec2& point, const std::vector<glm::vec2>& polygon) const;
+    // Command log for undo/redo; history[0, historyIndex) is applied
+    static constexpr size_t DEFAULT_HISTORY_BUDGET = 64 * 1024 * 1024;
+    std::deque<Command> history;
+    size_t historyIndex = 0;
+    size_t historyBytes = 0;
+    size_t historyBudget = DEFAULT_HISTORY_BUDGET;
 };
 
 } // namespace VectorSketch
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace VectorSketch {
+
+// A value shared between copies until one of them changes it: copying costs
+// a reference count, and write() first copies the value if another copy
+// still holds it. Copies may be read and dropped on any thread; each
+// instance is written by one thread at a time.
+template <typename T>
+class CopyOnWrite {
+public:
+    const T& operator*() const { return value ? *value : empty(); }
+    const T* operator->() const { return &**this; }
+
+    // The value, owned by this copy alone from now on
+    T& write() {
+        if (!value) {
+            value = std::make_shared<T>();
+        } else if (value.use_count() > 1) {
+            value = std::make_shared<T>(*value);
+        } else {
+            // The last other copy may have been dropped on another thread
+            // just now; its reads must happen before our writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *value;
+    }
+
+    void swap(CopyOnWrite& other) { value.swap(other.value); }
+
+private:
+    // Stands in for a moved-from or never-written value
+    static const T& empty() {
+        static const T instance;
+        return instance;
+    }
+
+    std::shared_ptr<T> value;
+};
+
+} // namespace VectorSketch
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Compile-time filters. Messages below VECTORSKETCH_LOG_LEVEL or outside the
+// VECTORSKETCH_LOG_CATEGORIES mask are discarded by `if constexpr`: their
+// arguments are never evaluated and no code is generated for them.
+//   -DVECTORSKETCH_LOG_LEVEL=0         keep everything, including per-stroke traces
+//   -DVECTORSKETCH_LOG_LEVEL=5         no logging at all
+//   -DVECTORSKETCH_LOG_CATEGORIES=0x14 only History and File
+#ifndef VECTORSKETCH_LOG_LEVEL
+#ifdef NDEBUG
+#define VECTORSKETCH_LOG_LEVEL 2  // Info
+#else
+#define VECTORSKETCH_LOG_LEVEL 1  // Debug
+#endif
+#endif
+
+#ifndef VECTORSKETCH_LOG_CATEGORIES
+#define VECTORSKETCH_LOG_CATEGORIES 0xFFFFFFFFu
+#endif
+
+namespace VectorSketch {
+namespace Log {
+
+enum class Level : int {
+    Trace = 0,  // Per stroke / per frame detail
+    Debug = 1,  // Per user action (undo, selection, ...)
+    Info = 2,   // Notable events (file saved, window opened)
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+enum class Category : uint32_t {
+    General = 1u << 0,
+    Canvas = 1u << 1,
+    History = 1u << 2,
+    Selection = 1u << 3,
+    File = 1u << 4,
+    Render = 1u << 5,
+    Smoothing = 1u << 6,
+    Addon = 1u << 7
+};
+
+constexpr bool compiledIn(Level level, Category category) {
+    return static_cast<int>(level) >= VECTORSKETCH_LOG_LEVEL &&
+           static_cast<int>(level) < static_cast<int>(Level::Off) &&
+           (static_cast<uint32_t>(category) & static_cast<uint32_t>(VECTORSKETCH_LOG_CATEGORIES)) != 0;
+}
+
+// Runtime threshold on top of the compile-time one (it cannot re-enable
+// messages that were compiled out). Defaults to the compile-time level.
+void setLevel(Level level);
+Level getLevel();
+bool enabled(Level level);
+
+// Hand a formatted message to the sink. Synchronous builds write it to
+// stdout (stderr for warnings and errors) without flushing stdout. With
+// VECTORSKETCH_LOG_ASYNC the message goes into a fixed-size ring buffer
+// drained by a background thread; messages are dropped when it is full.
+void write(Level level, Category category, const std::string& message);
+
+// Block until every queued message has been written (no-op when synchronous)
+void flush();
+
+} // namespace Log
+} // namespace VectorSketch
+
+#define VS_LOG(level, category, expr)                                                           \
+    do {                                                                                        \
+        if constexpr (::VectorSketch::Log::compiledIn(::VectorSketch::Log::Level::level,         \
+                                                      ::VectorSketch::Log::Category::category)) { \
+            if (::VectorSketch::Log::enabled(::VectorSketch::Log::Level::level)) {              \
+                std::ostringstream vsLogStream;                                                 \
+                vsLogStream << expr;                                                            \
+                ::VectorSketch::Log::write(::VectorSketch::Log::Level::level,                   \
+                                           ::VectorSketch::Log::Category::category,             \
+                                           vsLogStream.str());                                  \
+            }                                                                                   \
+        }                                                                                       \
+    } while (0)
+
+#define VS_TRACE(category, expr) VS_LOG(Trace, category, expr)
+#define VS_DEBUG(category, expr) VS_LOG(Debug, category, expr)
+#define VS_INFO(category, expr) VS_LOG(Info, category, expr)
+#define VS_WARN(category, expr) VS_LOG(Warn, category, expr)
+#define VS_ERROR(category, expr) VS_LOG(Error, category, expr)
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace VectorSketch {
+
+// Bounded lock-free ring buffer from any number of producer threads to one
+// consumer thread at a time. Producers claim a slot with one compare-and-swap
+// on the tail and publish it through the slot's sequence number, so a slow
+// producer only holds back the items behind its own slot. push() fails when
+// the ring is full and pop() when the next slot is not published yet.
+// Items are moved in and out, so T can own heap data.
+template <typename T>
+class MpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.reset(new Slot[size]);
+        for (size_t i = 0; i < size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        mask = size - 1;
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Any thread
+    bool push(T&& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots[t & mask];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(t);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false;  // The slot still holds an item from one lap ago
+            } else {
+                t = tail.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Consumers may change threads if the hand-off between
+    // them is synchronized (e.g. by a mutex).
+    bool pop(T& value) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        value = std::move(slot.value);
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    // Consumer only: hand every published item to `consume` in order.
+    // Returns the number of items.
+    template <typename Consume>
+    size_t drain(Consume&& consume) {
+        size_t count = 0;
+        T value;
+        while (pop(value)) {
+            consume(value);
+            ++count;
+        }
+        return count;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    // sequence == index: free for the producer claiming index;
+    // sequence == index + 1: published, for the consumer
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+
+    // Indices only grow; slot = index & mask
+    alignas(CACHE_LINE) size_t head = 0;              // Next slot to read
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};  // Next slot to claim
+};
+
+} // namespace VectorSketch
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace VectorSketch {
+
+// On-disk layout of .mm drawings.
+//
+// Version 1 (streamed): "MMVS", version, stroke count, then per stroke
+// color (3 floats), width, point count and interleaved points
+// (x, y, pressure, tiltX, tiltY, timestamp).
+//
+// Version 2 (mapped): a fixed header, a table with one record per stroke,
+// then one raw float column per point field, and optionally the pool's
+// levels of detail (their offsets, then the same six columns). Every block
+// is aligned, so a memory-mapped file can be read in place: opening costs one
+// pass over the stroke table plus a bulk copy of each column.
+namespace SketchFormat {
+
+constexpr char MAGIC[4] = {'M', 'M', 'V', 'S'};  // Mind Map Vector Sketch
+constexpr uint32_t VERSION_STREAMED = 1;
+constexpr uint32_t VERSION_MAPPED = 2;
+
+// Columns start on cache-line boundaries
+constexpr uint64_t COLUMN_ALIGNMENT = 64;
+
+// Column order in version 2 files
+enum Column { X, Y, PRESSURE, TILT_X, TILT_Y, TIMESTAMP, COLUMN_COUNT };
+
+struct HeaderV2 {
+    char magic[4];
+    uint32_t version;
+    uint32_t headerSize;                  // sizeof(HeaderV2)
+    uint32_t strokeRecordSize;            // sizeof(StrokeRecordV2)
+    uint64_t strokeCount;
+    uint64_t pointCount;
+    uint64_t strokeTableOffset;           // From the start of the file
+    uint64_t columnOffsets[COLUMN_COUNT]; // pointCount floats each
+    
+    // Levels of detail, in StrokePool's layout; lodLevels is 0 in files
+    // without them (written before they were stored)
+    uint64_t lodPointCount;
+    uint64_t lodOffsetsOffset;            // strokeCount * lodLevels + 1 uint32 offsets
+    uint64_t lodColumnsOffset;            // COLUMN_COUNT columns, columnBytes(lodPointCount) apart
+    uint32_t lodLevels;                   // StrokePool::LOD_LEVELS of the writer
+    uint8_t reserved[12];
+};
+
+// Strokes are stored back to back: firstPoint is the sum of the point counts
+// before it, and the counts add up to HeaderV2::pointCount
+struct StrokeRecordV2 {
+    uint64_t firstPoint;  // Index into the columns
+    uint32_t pointCount;
+    float baseWidth;
+    float color[3];
+    uint32_t flags;       // STROKE_FLAG_*; other bits reserved, 0
+    float bounds[4];      // minX, minY, maxX, maxY, padded by half the width; recomputed on load
+};
+
+// The stroke's points are Bézier control points (StrokeEncoding::Cubic)
+constexpr uint32_t STROKE_FLAG_CUBIC = 1;
+
+static_assert(sizeof(HeaderV2) == 128, "HeaderV2 layout changed");
+static_assert(sizeof(StrokeRecordV2) == 48, "StrokeRecordV2 layout changed");
+
+inline uint64_t alignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Bytes from one column to the next
+inline uint64_t columnBytes(uint64_t pointCount) {
+    return alignUp(pointCount * sizeof(float), COLUMN_ALIGNMENT);
+}
+
+} // namespace SketchFormat
+
+} // namespace VectorSketch
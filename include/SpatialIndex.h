@@ -0,0 +1,66 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace VectorSketch {
+
+// Dynamic loose-root quadtree over bounding boxes, keyed by stroke index.
+// The root grows as items land outside it, so the canvas stays unbounded.
+// Items live in the deepest node that fully contains them. Items reaching
+// past MAX_COORDINATE go to an overflow list checked by every query, so the
+// root never grows toward float overflow; non-finite boxes are not indexed.
+class SpatialIndex {
+public:
+    SpatialIndex() = default;
+    
+    void insert(size_t id, const BoundingBox& bounds);
+    
+    // Insert ids firstId .. firstId + count - 1 with the given boxes; the id
+    // tables and the root grow once for the whole batch
+    void insertRange(size_t firstId, const BoundingBox* bounds, size_t count);
+    void remove(size_t id);
+    void update(size_t id, const BoundingBox& bounds);
+    void clear();
+    
+    bool contains(size_t id) const { return id < itemNodes.size() && itemNodes[id] != nullptr; }
+    size_t size() const { return itemCount; }
+    
+    // Append ids whose box intersects area / contains point (unordered)
+    void queryRect(const BoundingBox& area, std::vector<size_t>& results) const;
+    void queryPoint(const glm::vec2& point, std::vector<size_t>& results) const;
+    
+private:
+    struct Node {
+        BoundingBox bounds;
+        std::vector<size_t> items;
+        std::unique_ptr<Node> children[4];
+        int depth = 0;
+        
+        bool isLeaf() const { return children[0] == nullptr; }
+    };
+    
+    static bool fitsTree(const BoundingBox& bounds);
+    void growRootToFit(const BoundingBox& bounds);
+    void insertIntoOverflow(size_t id);
+    void insertIntoNode(Node* node, size_t id);
+    void split(Node* node);
+    int childIndexFor(const Node* node, const BoundingBox& bounds) const;
+    static BoundingBox childBounds(const BoundingBox& parent, int quadrant);
+    void queryNode(const Node* node, const BoundingBox& area, std::vector<size_t>& results) const;
+    
+    static constexpr size_t NODE_CAPACITY = 8;
+    static constexpr int MAX_DEPTH = 20;
+    static constexpr float MIN_ROOT_SIZE = 1024.0f;
+    static constexpr float MAX_COORDINATE = 1e30f;  // The root stays within a few times this
+    
+    std::unique_ptr<Node> root;
+    std::unique_ptr<Node> overflow;       // Items past MAX_COORDINATE, never split
+    std::vector<BoundingBox> itemBounds;  // Indexed by id
+    std::vector<Node*> itemNodes;         // Node holding each id, nullptr if absent
+    size_t itemCount = 0;
+};
+
+} // namespace VectorSketch
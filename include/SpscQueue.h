@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace VectorSketch {
+
+// Bounded lock-free ring buffer between exactly one producer thread and one
+// consumer thread. Neither side blocks or allocates after construction:
+// push() fails when the ring is full and pop() when it is empty. Each side
+// keeps a cached copy of the other's index, so the shared cache lines are
+// only touched when the cached view says full (or empty).
+template <typename T>
+class SpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer thread only
+    bool push(const T& value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - producerHead == slots.size()) {
+            producerHead = head.load(std::memory_order_acquire);
+            if (t - producerHead == slots.size()) return false;
+        }
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool pop(T& value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == consumerTail) {
+            consumerTail = tail.load(std::memory_order_acquire);
+            if (h == consumerTail) return false;
+        }
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only: hand everything queued so far to `consume` in
+    // order, releasing the slots in one step. Returns the number of items.
+    template <typename Consume>
+    size_t drain(Consume&& consume) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        consumerTail = tail.load(std::memory_order_acquire);
+        for (size_t i = h; i != consumerTail; ++i) {
+            consume(slots[i & mask]);
+        }
+        head.store(consumerTail, std::memory_order_release);
+        return consumerTail - h;
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    // Indices only grow; slot = index & mask. Each side's cache line holds
+    // the index it writes and its cached copy of the other side's index.
+    alignas(CACHE_LINE) std::atomic<size_t> head{0};  // Next slot to read
+    size_t consumerTail = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> tail{0};  // Next slot to write
+    size_t producerHead = 0;
+};
+
+} // namespace VectorSketch
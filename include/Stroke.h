@@ -1,38 +1,171 @@
 #pragma once
 
 #include "StrokePoint.h"
+#include "BoundingBox.h"
 #include <vector>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 namespace VectorSketch {
 
+// How the points of a committed stroke are read
+enum class StrokeEncoding : uint8_t {
+    Samples,  // Input samples, smoothed with Catmull-Rom
+    Cubic     // Bézier control points p0 c1 c2 p1 c1 c2 p2 ... (3k + 1 points), see BezierSmoother::fitCubics
+};
+
+// Online decimation of incoming points (see Stroke::setInputFilter).
+// Distances are in world units; a default-constructed filter keeps every point.
+struct StrokeInputFilter {
+    bool enabled = false;
+    float minDistance = 0.0f;        // Closer to the last point (and same pressure): duplicate
+    float tolerance = 0.0f;          // Max distance of a dropped point from the kept polyline
+    float pressureTolerance = 0.0f;  // Max pressure difference from the interpolated one
+    
+    // Above 0, Canvas::endStroke replaces the samples with cubic curves
+    // fitted within this distance (independent of `enabled`)
+    float fitTolerance = 0.0f;
+    
+    // Same filter with distances multiplied by factor (screen pixels -> world units)
+    StrokeInputFilter scaled(float factor) const {
+        StrokeInputFilter result = *this;
+        result.minDistance *= factor;
+        result.tolerance *= factor;
+        result.fitTolerance *= factor;
+        return result;
+    }
+};
+
 // Represents a complete stroke with sampled points
 class Stroke {
 public:
-    Stroke() = default;
+    Stroke();
     
+    // Append a point. With an input filter set, duplicates are dropped and
+    // the previous last point is replaced instead of kept when the line from
+    // the point before it to the new one passes within tolerance (position
+    // and pressure) of every point dropped since; pressure peaks and dips
+    // beyond pressureTolerance therefore stay. The first and the newest
+    // point are always kept.
     void addPoint(const StrokePoint& point);
+    
+    void setInputFilter(const StrokeInputFilter& filter);
+    const StrokeInputFilter& getInputFilter() const { return inputFilter; }
+    
     void clear();
     
-    const std::vector<StrokePoint>& getPoints() const { return points; }
+    // Points are stored field by field (see StrokePointArrays)
+    const StrokePointArrays& getPoints() const { return points; }
+    StrokePoint getPoint(size_t i) const { return points.get(i); }
     bool isEmpty() const { return points.empty(); }
     size_t getPointCount() const { return points.size(); }
     
     // Get stroke color
     glm::vec3 getColor() const { return color; }
-    void setColor(const glm::vec3& c) { color = c; }
+    void setColor(const glm::vec3& c);
     
     // Get base width
     float getBaseWidth() const { return baseWidth; }
-    void setBaseWidth(float w) { baseWidth = w; }
+    void setBaseWidth(float w);
     
     // Move all points by delta (for lasso tool)
     void movePoints(const glm::vec2& delta);
     
+    // World-space box around the rendered stroke (points padded by half the width)
+    BoundingBox getBounds() const { return pointBounds.inflated(baseWidth * 0.5f); }
+    
+    // Identity shared by copies of this stroke (history snapshots keep it)
+    uint64_t getId() const { return id; }
+    
+    // Changes on every mutation; used by the renderer to invalidate cached geometry
+    uint64_t getRevision() const { return revision; }
+    
+    // Fresh stamps from the global counters, for strokes stored outside a Stroke
+    static uint64_t allocateId();
+    static uint64_t allocateRevision();
+    
 private:
-    std::vector<StrokePoint> points;
+    void touch();
+    bool canReplaceLast(const StrokePoint& point) const;
+    
+    // Dropped points the filter has to stay close to, bounded so a long
+    // straight run can't make each new point cost more
+    static constexpr size_t FILTER_MAX_DROPPED = 64;
+    
+    StrokePointArrays points;
     glm::vec3 color{0.0f, 0.0f, 0.0f}; // Black by default
     float baseWidth = 2.0f; // Base stroke width in pixels
+    BoundingBox pointBounds; // Kept up to date by addPoint/movePoints/clear
+    
+    StrokeInputFilter inputFilter;
+    std::vector<glm::vec3> filterDropped;  // x, y, pressure of points dropped since the second-to-last one
+    
+    uint64_t id;
+    uint64_t revision;
+};
+
+// Read-only view of one stroke, whether it lives in a Stroke or in a
+// StrokePool. Cheap to copy; valid until the owner is modified.
+class StrokeView {
+public:
+    // Per-field arrays of pointCount floats each
+    struct Columns {
+        const float* x;
+        const float* y;
+        const float* pressure;
+        const float* tiltX;
+        const float* tiltY;
+        const float* timestamp;
+    };
+    
+    StrokeView(const Stroke& stroke)
+        : columns{stroke.getPoints().x.data(), stroke.getPoints().y.data(),
+                  stroke.getPoints().pressure.data(), stroke.getPoints().tiltX.data(),
+                  stroke.getPoints().tiltY.data(), stroke.getPoints().timestamp.data()},
+          pointCount(stroke.getPointCount()), color(stroke.getColor()), baseWidth(stroke.getBaseWidth()),
+          bounds(stroke.getBounds()), id(stroke.getId()), revision(stroke.getRevision()) {}
+    
+    StrokeView(const Columns& columns, size_t pointCount, const glm::vec3& color, float baseWidth,
+               const BoundingBox& bounds, uint64_t id, uint64_t revision,
+               StrokeEncoding encoding = StrokeEncoding::Samples, int levelOfDetail = -1)
+        : columns(columns), pointCount(pointCount), color(color), baseWidth(baseWidth),
+          bounds(bounds), id(id), revision(revision), encoding(encoding), levelOfDetail(levelOfDetail) {}
+    
+    const float* getX() const { return columns.x; }
+    const float* getY() const { return columns.y; }
+    const float* getPressure() const { return columns.pressure; }
+    const Columns& getColumns() const { return columns; }
+    
+    StrokePoint getPoint(size_t i) const {
+        return StrokePoint(glm::vec2(columns.x[i], columns.y[i]), columns.pressure[i],
+                           columns.tiltX[i], columns.tiltY[i], columns.timestamp[i]);
+    }
+    glm::vec2 getPosition(size_t i) const { return glm::vec2(columns.x[i], columns.y[i]); }
+    
+    bool isEmpty() const { return pointCount == 0; }
+    size_t getPointCount() const { return pointCount; }
+    
+    glm::vec3 getColor() const { return color; }
+    float getBaseWidth() const { return baseWidth; }
+    BoundingBox getBounds() const { return bounds; }
+    uint64_t getId() const { return id; }
+    uint64_t getRevision() const { return revision; }
+    
+    StrokeEncoding getEncoding() const { return encoding; }
+    
+    // Simplified copy this view shows (see StrokePool::simplifiedView); -1 = every point
+    int getLevelOfDetail() const { return levelOfDetail; }
+    
+private:
+    Columns columns;
+    size_t pointCount;
+    glm::vec3 color;
+    float baseWidth;
+    BoundingBox bounds;
+    uint64_t id;
+    uint64_t revision;
+    StrokeEncoding encoding = StrokeEncoding::Samples;
+    int levelOfDetail = -1;
 };
 
 } // namespace VectorSketch
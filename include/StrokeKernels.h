@@ -0,0 +1,51 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace VectorSketch {
+
+// Hot loops over structure-of-arrays point data (see StrokePointArrays).
+// Each kernel reads one float array per coordinate and keeps its inner loop
+// branch-free, so compilers turn it into SSE/AVX2/NEON code at -O3.
+class StrokeKernels {
+public:
+    // x[i] += delta.x, y[i] += delta.y
+    static void translate(float* x, float* y, size_t count, const glm::vec2& delta);
+    
+    // Box around the points (empty for count == 0). NaN coordinates after
+    // the first point are skipped, so check allFinite on untrusted data
+    static BoundingBox computeBounds(const float* x, const float* y, size_t count);
+    
+    // False if any coordinate is NaN or infinite
+    static bool allFinite(const float* x, const float* y, size_t count);
+    
+    // True if at least one point lies inside the polygon (even-odd rule,
+    // same ray casting as the lasso used on single points)
+    static bool anyPointInPolygon(const float* x, const float* y, size_t count,
+                                  const std::vector<glm::vec2>& polygon);
+    
+    // Catmull-Rom to Bézier control points for the count - 1 segments
+    // between consecutive points; endpoints reuse themselves as neighbours.
+    // Outputs hold count - 1 floats each.
+    static void catmullRomControlPoints(const float* x, const float* y, size_t count, float tension,
+                                        float* c1x, float* c1y, float* c2x, float* c2y);
+    
+    // Ramer-Douglas-Peucker for every tolerance at once: errors[i] is the
+    // largest tolerance at which the simplification still keeps point i
+    // (infinity for the endpoints, 0 for points dropped at minTolerance).
+    // Keeping the points with errors[i] > t gives the RDP result for t.
+    // Distances cover position and half width (pressure * halfWidthScale).
+    static void simplificationErrors(const float* x, const float* y, const float* pressure, size_t count,
+                                     float halfWidthScale, float minTolerance, float* errors);
+    
+private:
+    // Points tested against the polygon per pass; the crossing flags for a
+    // block stay in L1 while every edge is applied to it
+    static constexpr size_t POLYGON_BLOCK = 256;
+};
+
+} // namespace VectorSketch
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <glm/glm.hpp>
+#include <vector>
 
 namespace VectorSketch {
 
@@ -20,4 +21,73 @@ struct StrokePoint {
         : position(pos), pressure(press), tiltX(tx), tiltY(ty), timestamp(time) {}
 };
 
+// Structure-of-arrays storage for StrokePoint: one contiguous array per field,
+// so loops that only need positions (or only pressure) stream just those
+struct StrokePointArrays {
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> pressure;
+    std::vector<float> tiltX;
+    std::vector<float> tiltY;
+    std::vector<float> timestamp;
+    
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    
+    StrokePoint get(size_t i) const {
+        return StrokePoint(glm::vec2(x[i], y[i]), pressure[i], tiltX[i], tiltY[i], timestamp[i]);
+    }
+    
+    void push_back(const StrokePoint& point) {
+        x.push_back(point.position.x);
+        y.push_back(point.position.y);
+        pressure.push_back(point.pressure);
+        tiltX.push_back(point.tiltX);
+        tiltY.push_back(point.tiltY);
+        timestamp.push_back(point.timestamp);
+    }
+    
+    void set(size_t i, const StrokePoint& point) {
+        x[i] = point.position.x;
+        y[i] = point.position.y;
+        pressure[i] = point.pressure;
+        tiltX[i] = point.tiltX;
+        tiltY[i] = point.tiltY;
+        timestamp[i] = point.timestamp;
+    }
+    
+    // Copy points [first, last) of other to the end, one bulk copy per column
+    void append(const StrokePointArrays& other, size_t first, size_t last) {
+        x.insert(x.end(), other.x.begin() + first, other.x.begin() + last);
+        y.insert(y.end(), other.y.begin() + first, other.y.begin() + last);
+        pressure.insert(pressure.end(), other.pressure.begin() + first, other.pressure.begin() + last);
+        tiltX.insert(tiltX.end(), other.tiltX.begin() + first, other.tiltX.begin() + last);
+        tiltY.insert(tiltY.end(), other.tiltY.begin() + first, other.tiltY.begin() + last);
+        timestamp.insert(timestamp.end(), other.timestamp.begin() + first, other.timestamp.begin() + last);
+    }
+    
+    void reserve(size_t n) {
+        for (auto* column : {&x, &y, &pressure, &tiltX, &tiltY, &timestamp}) column->reserve(n);
+    }
+    
+    void resize(size_t n) {
+        for (auto* column : {&x, &y, &pressure, &tiltX, &tiltY, &timestamp}) column->resize(n);
+    }
+    
+    void clear() {
+        for (auto* column : {&x, &y, &pressure, &tiltX, &tiltY, &timestamp}) column->clear();
+    }
+    
+    void swap(StrokePointArrays& other) {
+        x.swap(other.x);
+        y.swap(other.y);
+        pressure.swap(other.pressure);
+        tiltX.swap(other.tiltX);
+        tiltY.swap(other.tiltY);
+        timestamp.swap(other.timestamp);
+    }
+    
+    size_t capacity() const { return x.capacity(); }
+};
+
 } // namespace VectorSketch
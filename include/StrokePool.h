@@ -0,0 +1,166 @@
+#pragma once
+
+#include "Stroke.h"
+#include "BoundingBox.h"
+#include "CopyOnWrite.h"
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace VectorSketch {
+
+// Committed strokes in CSR layout: every point lives in one set of contiguous
+// per-field arrays (x, y, pressure, ...) and stroke i owns points
+// [offsets[i], offsets[i + 1]). Per-stroke attributes sit in parallel arrays,
+// so a stroke costs no allocation of its own and scans over the canvas walk
+// memory linearly, touching only the fields they need.
+//
+// Each stroke also keeps a chain of simplified copies (levels of detail)
+// in a second set of arrays, so zoomed-out views can draw a few points per
+// stroke instead of all of them.
+//
+// Copying a pool shares its arrays (copy-on-write): a snapshot costs a
+// reference count, and the first change to either copy afterwards copies
+// the arrays for it. Snapshots may be read on other threads.
+class StrokePool {
+public:
+    // Simplified copies per sampled stroke: level k keeps the points that
+    // Ramer-Douglas-Peucker keeps at LOD_TOLERANCES[k] world units (position
+    // and half width). A level keeping more than 3/4 of the points of the
+    // finer one is not stored. Cubic strokes are compact already and only
+    // collapse to dots.
+    static constexpr int LOD_LEVELS = 4;
+    static constexpr float LOD_TOLERANCES[LOD_LEVELS] = {0.5f, 2.0f, 8.0f, 32.0f};
+    
+    // Shorter strokes are cheap enough to draw whole (and still become dots)
+    static constexpr size_t LOD_MIN_POINTS = 32;
+    
+    // Level of a view reduced to its first point (a dot)
+    static constexpr int LOD_DOT = LOD_LEVELS;
+    
+    StrokePool() = default;
+    
+    size_t size() const { return storage->ids.size(); }
+    bool empty() const { return storage->ids.empty(); }
+    size_t getTotalPointCount() const { return storage->points.size(); }
+    
+    void reserve(size_t strokeCount, size_t pointCount);
+    void clear();
+    void swap(StrokePool& other);
+    
+    // Copy a stroke in, keeping its id and revision; returns its index
+    size_t append(const StrokeView& stroke);
+    
+    // Copy interleaved points in as a new stroke with fresh id and revision
+    size_t append(const StrokePoint* strokePoints, size_t count, const glm::vec3& color, float baseWidth,
+                  StrokeEncoding encoding = StrokeEncoding::Samples);
+    
+    // Copy stroke i of another pool, with its levels of detail (no re-simplification)
+    size_t appendFrom(const StrokePool& other, size_t i);
+    
+    // Copy strokes [first, last) of another pool the same way, with one bulk
+    // copy per column; returns the index of the first copied stroke
+    size_t appendRange(const StrokePool& other, size_t first, size_t last);
+    
+    // Append strokeCount new strokes from caller-packed data in one pass:
+    // stroke s owns points [pointOffsets[s], pointOffsets[s + 1]) of
+    // packedPoints, each point `stride` floats in StrokePoint order (x, y,
+    // pressure, tiltX, tiltY, timestamp; fields past the stride keep
+    // StrokePoint's defaults). colors holds r, g, b per stroke. Strokes get
+    // fresh ids and revisions; returns the index of the first one.
+    // Unchecked: the caller guarantees 2 <= stride <= 6 and strokeCount + 1
+    // strictly increasing offsets within packedPoints (the addon validates
+    // them before calling).
+    size_t appendPacked(const float* packedPoints, size_t stride, const uint32_t* pointOffsets, size_t strokeCount,
+                        const float* colors, const float* baseWidths);
+    
+    // Levels of detail of consecutive strokes in the pool's own layout (see
+    // getLevelOfDetailPoints), e.g. as saved in a file
+    struct LevelOfDetailColumns {
+        StrokeView::Columns columns;
+        const uint32_t* offsets;  // strokeCount * LOD_LEVELS + 1 entries, from 0
+    };
+    
+    // Append strokeCount new strokes whose points arrive column by column
+    // (file loads): stroke s owns points [pointOffsets[s], pointOffsets[s + 1])
+    // of columns, pointOffsets[0] is 0 and the offsets never decrease. Each
+    // column is copied in one piece; strokes get fresh ids and revisions.
+    // Levels of detail are copied from `levels` when given, else built.
+    size_t appendColumns(const StrokeView::Columns& columns, const uint32_t* pointOffsets, size_t strokeCount,
+                         const glm::vec3* strokeColors, const float* baseWidths, const BoundingBox* strokeBounds,
+                         const StrokeEncoding* strokeEncodings, const LevelOfDetailColumns* levels = nullptr);
+    
+    // Drop the last stroke (strokes are only ever removed from the end)
+    void popBack();
+    
+    // Drop every stroke from index count on
+    void truncate(size_t count);
+    
+    // Move every point of stroke i by delta
+    void translate(size_t i, const glm::vec2& delta);
+    
+    StrokeView view(size_t i) const;
+    
+    // Coarsest view of stroke i that stays within maxError world units of
+    // it: a dot when the whole stroke fits in maxError, otherwise the
+    // coarsest stored level whose error bound allows it, otherwise view(i)
+    StrokeView simplifiedView(size_t i, float maxError) const;
+    
+    // Every point of every stroke, field by field, in stroke order
+    const StrokePointArrays& getPointArrays() const { return storage->points; }
+    
+    const float* getX(size_t i) const { return storage->points.x.data() + storage->offsets[i]; }
+    const float* getY(size_t i) const { return storage->points.y.data() + storage->offsets[i]; }
+    size_t getPointCount(size_t i) const { return storage->offsets[i + 1] - storage->offsets[i]; }
+    glm::vec3 getColor(size_t i) const { return storage->colors[i]; }
+    float getBaseWidth(size_t i) const { return storage->widths[i]; }
+    BoundingBox getBounds(size_t i) const { return storage->bounds[i]; }  // Padded by half the width
+    uint64_t getId(size_t i) const { return storage->ids[i]; }
+    uint64_t getRevision(size_t i) const { return storage->revisions[i]; }
+    StrokeEncoding getEncoding(size_t i) const { return storage->encodings[i]; }
+    
+    // Per-stroke arrays in stroke order, for bulk readers: stroke i owns
+    // points [getOffsets()[i], getOffsets()[i + 1]) of getPointArrays()
+    const std::vector<uint32_t>& getOffsets() const { return storage->offsets; }
+    const std::vector<uint64_t>& getIds() const { return storage->ids; }
+    const std::vector<glm::vec3>& getColors() const { return storage->colors; }
+    const std::vector<float>& getBaseWidths() const { return storage->widths; }
+    const std::vector<BoundingBox>& getAllBounds() const { return storage->bounds; }
+    const std::vector<StrokeEncoding>& getEncodings() const { return storage->encodings; }
+    
+    // Every stored level of every stroke: level k of stroke i owns points
+    // [offsets[i * LOD_LEVELS + k], offsets[i * LOD_LEVELS + k + 1])
+    const StrokePointArrays& getLevelOfDetailPoints() const { return storage->lodPoints; }
+    const std::vector<uint32_t>& getLevelOfDetailOffsets() const { return storage->lodOffsets; }
+    
+    // Changes on every modification and moves with the contents on swap(),
+    // so two reads returning the same value saw the same strokes
+    uint64_t getVersion() const { return version; }
+    
+    // Bytes allocated by the pool, including arrays it shares with copies
+    size_t getMemoryUsage() const;
+    
+private:
+    struct Storage {
+        StrokePointArrays points;
+        std::vector<uint32_t> offsets{0};  // size() + 1 entries
+        std::vector<uint64_t> ids;
+        std::vector<uint64_t> revisions;
+        std::vector<glm::vec3> colors;
+        std::vector<float> widths;
+        std::vector<BoundingBox> bounds;
+        std::vector<StrokeEncoding> encodings;
+        
+        // Level k of stroke i owns lodPoints [lodOffsets[i * LOD_LEVELS + k], lodOffsets[i * LOD_LEVELS + k + 1])
+        StrokePointArrays lodPoints;
+        std::vector<uint32_t> lodOffsets{0};  // size() * LOD_LEVELS + 1 entries
+    };
+    CopyOnWrite<Storage> storage;
+    
+    static void buildLevelsOfDetail(Storage& pool, size_t i);
+    StrokeView lodView(size_t i, int level) const;
+    
+    uint64_t version = 0;  // Drawn from the global revision counter; 0 = never modified
+};
+
+} // namespace VectorSketch
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Stroke.h"
 #include <glm/glm.hpp>
 
 namespace VectorSketch {
@@ -36,12 +37,17 @@ public:
     // Check if mouse is over UI (to prevent drawing)
     bool isMouseOverUI() const { return mouseOverUI; }
     
+    // Input decimation for strokes drawn with each tool, distances in screen pixels
+    const StrokeInputFilter& getInputFilter(ToolType tool) const { return inputFilters[static_cast<int>(tool)]; }
+    void setInputFilter(ToolType tool, const StrokeInputFilter& filter) { inputFilters[static_cast<int>(tool)] = filter; }
+    
 private:
     ToolType currentTool;
     float brushWidth;
     glm::vec3 currentColor;
     bool mouseOverUI;
     bool wheelVisible;
+    StrokeInputFilter inputFilters[3];  // Indexed by ToolType
 };
 
 } // namespace VectorSketch
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Stroke.h"
+#include "StrokePool.h"
 #include "BezierSmoother.h"
 #include <GL/glew.h>
 #include <glm/glm.hpp>
@@ -8,9 +9,37 @@
 #include <glm/gtc/matrix_inverse.hpp>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <functional>
 
 namespace VectorSketch {
 
+// Indices of the committed strokes overlapping a world-space area, in paint order
+using StrokeQuery = std::function<std::vector<size_t>(const BoundingBox& area)>;
+
+// How completed strokes are submitted to the GPU
+enum class RenderMode {
+    PerStroke,   // One glDrawArrays per stroke, color as a uniform
+    Batched,     // All strokes share one buffer, drawn with glMultiDrawArrays
+    GpuExpanded  // Only Bézier segments are uploaded; a vertex shader samples
+                 // and extrudes them, one instance per segment
+};
+
+// How stroke outlines are turned into triangles
+enum class TessellationMode {
+    Fixed,     // 15 samples per Bézier segment, 16-segment caps
+    Adaptive   // Sample counts follow a screen-space error tolerance and the zoom
+};
+
+// How stroke edges are smoothed; chosen once, at VectorRenderer::initialize
+enum class Antialiasing {
+    Multisample,  // Relies on the window's MSAA samples (GLFW_SAMPLES)
+    Analytic      // Coverage from the distance to the centerline, computed in
+                  // the fragment shader over a one-pixel fringe; meant for
+                  // single-sample windows. Strokes are always GPU-expanded,
+                  // since only that path knows the centerline per fragment
+};
+
 // GPU-accelerated vector renderer using OpenGL
 class VectorRenderer {
 public:
@@ -18,13 +47,89 @@ public:
     ~VectorRenderer();
     
     // Initialize renderer with window dimensions
-    bool initialize(int width, int height);
+    bool initialize(int width, int height, Antialiasing antialiasing = Antialiasing::Multisample);
+    
+    Antialiasing getAntialiasing() const { return antialiasing; }
     
     // Begin frame rendering
     void beginFrame();
     
-    // Render a stroke
-    void renderStroke(const Stroke& stroke);
+    // Render a stroke (geometry is cached per stroke and rebuilt only when it changes)
+    void renderStroke(const StrokeView& stroke);
+    
+    // Render the stroke being drawn. Only the tail touched by new points is
+    // re-smoothed and re-tessellated, and the new vertices are written into a
+    // growing buffer with glBufferSubData, so per-frame cost does not depend
+    // on how long the stroke already is
+    void renderLiveStroke(const Stroke& stroke);
+    
+    // Submit a completed stroke. Drawn immediately in PerStroke mode;
+    // in Batched and GpuExpanded modes (and always with analytic
+    // antialiasing) it is queued and drawn by flushBatch()
+    void submitStroke(const StrokeView& stroke);
+    
+    // Submit stroke `index` of a pool at the coarsest level of detail that
+    // stays within a pixel of it at the current zoom. Strokes that fit in a
+    // pixel are drawn as a dot, skipped when the pixel already got a dot of
+    // the same color, so zoomed-out views cost about one dot per pixel
+    void submitStroke(const StrokePool& strokes, size_t index);
+    
+    // Draw strokes from the simplified copies kept by StrokePool
+    void setStrokeSimplification(bool enabled);
+    bool isSimplifyingStrokes() const { return strokeSimplification; }
+    
+    // Draw every stroke queued since the last flush in a single call
+    void flushBatch();
+    
+    void setRenderMode(RenderMode mode);
+    RenderMode getRenderMode() const { return renderMode; }
+    
+    // Bytes of stroke geometry sent to the GPU so far (strips, batch slots,
+    // segment records and the live stroke), for comparing the modes
+    uint64_t getUploadedBytes() const { return uploadedBytes; }
+    
+    void setTessellationMode(TessellationMode mode);
+    TessellationMode getTessellationMode() const { return tessellationMode; }
+    
+    // Maximum outline error in pixels for TessellationMode::Adaptive
+    void setTessellationTolerance(float pixels);
+    float getTessellationTolerance() const { return tessellationTolerance; }
+    
+    // Composited rendering: committed strokes are drawn once into an
+    // offscreen texture and reused while the view and the strokes stay the
+    // same, so frames where only the live stroke changes cost the same on
+    // any canvas size
+    void setCompositing(bool enabled);
+    bool isCompositing() const { return compositing; }
+    
+    // Open the static layer for committed strokes whose contents are
+    // identified by contentVersion. Returns true when they must be submitted
+    // (the cached layer is out of date, or compositing is off) and false
+    // when the cached layer still matches and submission can be skipped.
+    // `damage` is the world area where the strokes changed since the last
+    // call, or empty when unknown. If only the content changed, the layer is
+    // patched: just that rectangle is cleared and redrawn (scissored), and
+    // getRedrawBounds() shrinks to it
+    bool beginStaticLayer(uint64_t contentVersion, const BoundingBox& damage = BoundingBox());
+    
+    // Close the static layer and draw it into the window
+    void endStaticLayer();
+    
+    // Tile pyramid: committed strokes are rasterized into TILE_SIZE-pixel
+    // tiles at power-of-two zoom levels, kept in a texture atlas and drawn
+    // as textured quads, so panning over visited areas redraws no strokes
+    void setTileCaching(bool enabled);
+    bool isTileCaching() const { return tileCaching; }
+    
+    // Draw the committed strokes in view from the tile cache, rendering
+    // missing tiles and tiles whose strokes changed through `query`.
+    // Returns false when tiles can't be used this frame (more visible tiles
+    // than the atlas holds, no framebuffer support); the caller then
+    // submits the strokes directly
+    bool renderTiles(const StrokePool& strokes, const StrokeQuery& query);
+    
+    // Release all cached stroke geometry
+    void clearGeometryCache();
     
     // End frame rendering
     void endFrame();
@@ -40,12 +145,199 @@ public:
     
     glm::mat4 getViewTransform() const { return viewTransform; }
     
+    // Screen pixels per world unit
+    float getViewScale() const { return glm::length(glm::vec3(viewTransform[0])); }
+    
     // Coordinate transformation
     glm::vec2 screenToWorld(const glm::vec2& screenPos) const;
     
+    // World-space area covered by the window under the current view
+    BoundingBox getVisibleBounds() const;
+    
+    // World-space area the strokes submitted this frame must cover: the
+    // visible area, or only its damaged part while the static layer is patched
+    BoundingBox getRedrawBounds() const { return frameBounds; }
+    
+    // The view, the window size or a drawing setting changed since the last
+    // endFrame(), so the window contents are out of date
+    bool needsRedraw() const { return redrawNeeded; }
+    
 private:
+    // Triangle strip of one stroke, kept on the GPU between frames
+    struct StrokeGeometry {
+        GLuint vbo = 0;
+        GLsizei vertexCount = 0;
+        uint64_t revision = 0;
+        int detailLevel = 0;
+        int levelOfDetail = -1;  // StrokeView::getLevelOfDetail() it was built from
+        uint64_t lastUsedFrame = 0;
+    };
+    
+    // Vertex layout of the shared batch buffer
+    struct BatchVertex {
+        glm::vec2 position;
+        GLubyte color[4];
+    };
+    
+    // Range of a slot buffer holding one stroke
+    struct BatchSlot {
+        GLint first = 0;
+        GLsizei count = 0;
+        uint64_t revision = 0;
+        int detailLevel = 0;
+        int levelOfDetail = -1;
+        uint64_t lastUsedFrame = 0;
+    };
+    
+    // One growing buffer with a slot per stroke. Slots of strokes that
+    // changed size or disappeared become garbage until compaction.
+    struct SlotBuffer {
+        GLuint vbo = 0;
+        GLsizeiptr elementSize = 0;
+        GLsizei padding = 0;   // Spare elements always kept after the last slot
+        GLsizei capacity = 0;  // In elements
+        GLsizei used = 0;
+        GLsizei garbage = 0;
+        std::unordered_map<uint64_t, BatchSlot> slots;
+    };
+    
+    // GpuExpanded mode: one Bézier segment per record. The segment's end
+    // point is the next record's p0, so a stroke of n segments takes n + 1
+    // records; the last one only draws the end cap. Its c1 and c2 are a
+    // point of the stroke before the end (the end itself for dots), which
+    // tells the cap where the body is.
+    struct SegmentRecord {
+        glm::vec2 p0;
+        glm::vec2 c1;
+        glm::vec2 c2;
+        float width;        // At p0
+        GLubyte color[4];   // Alpha: 255 first segment, 128 inner, 0 closing record
+    };
+    
+    // Strip of the stroke being drawn, extended in place as points arrive.
+    // Layout matches BezierSmoother's strips: start cap | body | end cap.
+    // With Antialiasing::Analytic the buffer holds segment records instead.
+    struct LiveStroke {
+        uint64_t id = 0;
+        uint64_t revision = 0;
+        int detailLevel = 0;
+        float baseWidth = 0.0f;
+        glm::vec3 color{0.0f};
+        int capSegments = 0;
+        std::vector<BezierSegment> segments;
+        std::vector<size_t> segmentStarts;  // First centerline sample of each segment
+        std::vector<glm::vec2> centerPoints;
+        std::vector<glm::vec2> vertices;    // CPU mirror of the GPU buffer
+        std::vector<SegmentRecord> records;
+        GLuint vbo = 0;
+        GLsizei capacity = 0;               // In vertices (or records)
+    };
+    
+    // Offscreen copy of the committed strokes and the state it was drawn for
+    struct StaticLayer {
+        GLuint fbo = 0;
+        GLuint texture = 0;
+        GLuint msaaFbo = 0;      // Multisampled target, resolved into texture
+        GLuint msaaColor = 0;
+        int width = 0;
+        int height = 0;
+        bool valid = false;
+        bool redrawing = false;  // Strokes of this frame go into the layer
+        bool patching = false;   // ...and only inside scissorRect
+        glm::ivec4 scissorRect{0};  // x, y, width, height in framebuffer pixels
+        uint64_t contentVersion = 0;
+        glm::mat4 viewTransform{1.0f};
+        TessellationMode tessellationMode = TessellationMode::Adaptive;
+        float tessellationTolerance = 0.0f;
+    };
+    
+    // One tile of the pyramid: level L covers TILE_SIZE / 2^L world units per side
+    struct TileKey {
+        int level = 0;
+        int64_t x = 0;
+        int64_t y = 0;
+        bool operator==(const TileKey& other) const {
+            return level == other.level && x == other.x && y == other.y;
+        }
+    };
+    
+    struct TileKeyHash {
+        size_t operator()(const TileKey& key) const {
+            uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<uint64_t>(key.y) + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+            h ^= static_cast<uint64_t>(key.level) + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+    
+    struct Tile {
+        int slot = -1;              // Atlas slot, -1 when the tile is empty
+        uint64_t poolVersion = 0;   // StrokePool version the tile was last checked against
+        uint64_t signature = 0;     // Hash of the ids and revisions drawn into it
+        bool checked = false;
+        uint64_t lastUsedFrame = 0;
+    };
+    
+    struct TileVertex {
+        glm::vec2 position;  // World space
+        glm::vec2 uv;        // Atlas
+    };
+    
     void createShaders();
     void updateProjection();
+    std::vector<glm::vec2> tessellate(const StrokeView& stroke) const;
+    int computeDetailLevel() const;
+    void buildGeometry(const StrokeView& stroke, StrokeGeometry& geometry);
+    bool updateLiveStroke(const Stroke& stroke);
+    void updateLiveSegments(const Stroke& stroke);
+    void evictStaleGeometry();
+    
+    // Drop strips built with the previous tessellation settings
+    void invalidateTessellation();
+    
+    void queueBatchStroke(const StrokeView& stroke);
+    void queueSegmentStroke(const StrokeView& stroke);
+    static void appendSegmentRecords(std::vector<SegmentRecord>& records,
+                                     const std::vector<BezierSegment>& segments, size_t firstSegment,
+                                     float width, const glm::vec3& color);
+    void writeSlot(SlotBuffer& buffer, BatchSlot& slot, const void* data, GLsizei count);
+    void reserveSlotCapacity(SlotBuffer& buffer, GLsizei count);
+    void compactSlotBuffer(SlotBuffer& buffer);
+    void bindBatchAttributes();
+    void drawSegmentRuns();
+    void drawSegmentRecords(GLuint buffer, const GLint* firsts, const GLsizei* counts, size_t runs);
+    
+    bool ensureStaticLayerTargets();
+    void releaseStaticLayer();
+    
+    bool ensureTileAtlas();
+    void releaseTileCache();
+    int allocateTileSlot();
+    void renderTile(const TileKey& key, int slot, const StrokePool& strokes, const std::vector<size_t>& indices);
+    void drawTileQuads();
+    
+    // Cached geometry is dropped after this many frames without being drawn
+    static constexpr uint64_t GEOMETRY_MAX_IDLE_FRAMES = 600;
+    static constexpr uint64_t GEOMETRY_EVICT_INTERVAL = 120;
+    
+    // Zoom octaves covered by adaptive tessellation (2^-20 .. 2^20)
+    static constexpr int MAX_DETAIL_LEVEL = 20;
+    
+    // Tile pyramid
+    static constexpr int TILE_SIZE = 256;          // Pixels per side
+    static constexpr int TILE_ATLAS_MAX_SIZE = 4096;  // Up to 256 tiles, 64 MB
+    
+    // Slot buffer sizing, in elements (vertices or segment records)
+    static constexpr GLsizei BATCH_MIN_CAPACITY = 1 << 16;
+    static constexpr GLsizei BATCH_COMPACT_MIN_GARBAGE = 1 << 15;
+    static constexpr GLsizei LIVE_MIN_CAPACITY = 4096;
+    
+    // GpuExpanded sampling: every instance emits this many centerline
+    // samples and cap segments; in Adaptive mode the shader collapses the
+    // ones the error tolerance doesn't need
+    static constexpr int GPU_FIXED_SAMPLES = 15;
+    static constexpr int GPU_MAX_SAMPLES = 32;
+    static constexpr int GPU_CAP_SEGMENTS = 16;
     
     GLuint shaderProgram;
     GLuint vao, vbo;
@@ -58,6 +350,85 @@ private:
     GLint uMVP;
     GLint uColor;
     GLint uLineWidth;
+    
+    // Visible world area for the frame being drawn; strokes outside it are skipped
+    BoundingBox frameBounds;
+    
+    TessellationMode tessellationMode = TessellationMode::Adaptive;
+    float tessellationTolerance = 0.25f;
+    
+    // Adaptive geometry is built for a power-of-two zoom (2^level pixels per
+    // unit) at or above the current one, and rebuilt when the zoom crosses
+    // into another octave. Always 0 in Fixed mode.
+    int frameDetailLevel = 0;
+    
+    // Stroke simplification: world units one pixel covers in the frame being
+    // drawn, and the color of the last sub-pixel stroke drawn into each pixel
+    bool strokeSimplification = true;
+    float framePixelSize = 1.0f;
+    std::unordered_map<uint64_t, uint32_t> frameDotCells;
+    
+    LiveStroke liveStroke;
+    
+    // Stroke id -> cached GPU geometry
+    std::unordered_map<uint64_t, StrokeGeometry> geometryCache;
+    uint64_t frameIndex = 0;
+    
+    RenderMode renderMode = RenderMode::PerStroke;
+    Antialiasing antialiasing = Antialiasing::Multisample;
+    
+    uint64_t uploadedBytes = 0;
+    
+    // Batched mode: strokes live in slots of one growing vertex buffer
+    GLuint batchProgram = 0;
+    GLuint batchVao = 0;
+    GLint uBatchMVP = -1;
+    SlotBuffer batchBuffer;
+    std::vector<GLint> batchFirsts;
+    std::vector<GLsizei> batchCounts;
+    
+    // GpuExpanded mode: strokes live in slots of one segment record buffer.
+    // Queued slots that follow each other in the buffer are drawn as one run.
+    GLuint segmentProgram = 0;
+    GLuint segmentVao = 0;
+    GLint uSegmentMVP = -1;
+    GLint uSegmentSamples = -1;
+    GLint uSegmentCapSegments = -1;
+    GLint uSegmentPixelsPerUnit = -1;
+    GLint uSegmentTolerance = -1;
+    GLint uSegmentFringe = -1;
+    SlotBuffer segmentBuffer;
+    std::vector<GLint> segmentFirsts;
+    std::vector<GLsizei> segmentCounts;
+    
+    // Composited mode
+    bool compositing = true;
+    StaticLayer staticLayer;
+    bool staticLayerReused = false;  // This frame drew the cached layer as is
+    bool redrawNeeded = true;
+    GLuint compositeProgram = 0;
+    GLuint compositeVao = 0;
+    GLint uCompositeLayer = -1;
+    GLint windowSamples = 0;         // MSAA samples of the default framebuffer
+    
+    // Tile pyramid: slots of one atlas texture, reused least recently used first
+    bool tileCaching = true;
+    GLuint tileAtlas = 0;
+    GLuint tileAtlasFbo = 0;
+    GLuint tileMsaaFbo = 0;          // Tiles are drawn here and resolved into the atlas
+    GLuint tileMsaaColor = 0;
+    int tileAtlasSize = 0;
+    int tileSlotsPerRow = 0;
+    std::vector<int> freeTileSlots;
+    std::unordered_map<TileKey, Tile, TileKeyHash> tiles;
+    uint64_t tileFrame = 0;
+    TessellationMode tileTessellationMode = TessellationMode::Adaptive;
+    float tileTessellationTolerance = 0.0f;
+    GLuint tileProgram = 0;
+    GLuint tileVao = 0, tileVbo = 0;
+    GLint uTileMVP = -1;
+    GLint uTileAtlas = -1;
+    std::vector<TileVertex> tileVertices;
 };
 
 } // namespace VectorSketch
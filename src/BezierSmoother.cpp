@@ -1,75 +1,343 @@
 #include "BezierSmoother.h"
+#include "StrokeKernels.h"
+#include "Log.h"
 #include <cmath>
 #include <algorithm>
-#include <iostream>
 
 namespace VectorSketch {
 
-std::vector<BezierSegment> BezierSmoother::smooth(const Stroke& stroke, float tension) {
+std::vector<BezierSegment> BezierSmoother::smooth(const StrokeView& stroke, float tension) {
     std::vector<BezierSegment> segments;
-    const auto& points = stroke.getPoints();
+    const size_t pointCount = stroke.getPointCount();
+    const float* x = stroke.getX();
+    const float* y = stroke.getY();
+    const float* pressure = stroke.getPressure();
+    const float baseWidth = stroke.getBaseWidth();
     
-    if (points.empty()) {
+    if (pointCount == 0) {
         return segments;
     }
     
     // Special case: single point (dot)
-    if (points.size() == 1) {
+    if (pointCount == 1) {
         BezierSegment seg;
-        seg.p0 = points[0].position;
-        seg.p1 = points[0].position;  // Same point (degenerate segment)
-        seg.c1 = points[0].position;
-        seg.c2 = points[0].position;
-        seg.widthStart = points[0].pressure * stroke.getBaseWidth();
-        seg.widthEnd = points[0].pressure * stroke.getBaseWidth();
+        seg.p0 = stroke.getPosition(0);
+        seg.p1 = seg.p0;  // Same point (degenerate segment)
+        seg.c1 = seg.p0;
+        seg.c2 = seg.p0;
+        seg.widthStart = pressure[0] * baseWidth;
+        seg.widthEnd = pressure[0] * baseWidth;
         segments.push_back(seg);
         return segments;
     }
     
+    // Stored curves: every third point is a knot
+    if (stroke.getEncoding() == StrokeEncoding::Cubic && (pointCount - 1) % 3 == 0) {
+        segments.resize((pointCount - 1) / 3);
+        for (size_t i = 0; i < segments.size(); ++i) {
+            const size_t knot = i * 3;
+            BezierSegment& seg = segments[i];
+            seg.p0 = glm::vec2(x[knot], y[knot]);
+            seg.c1 = glm::vec2(x[knot + 1], y[knot + 1]);
+            seg.c2 = glm::vec2(x[knot + 2], y[knot + 2]);
+            seg.p1 = glm::vec2(x[knot + 3], y[knot + 3]);
+            seg.widthStart = pressure[knot] * baseWidth;
+            seg.widthEnd = pressure[knot + 3] * baseWidth;
+        }
+        return segments;
+    }
+    
     // For very short strokes, just create a simple line
-    if (points.size() == 2) {
+    if (pointCount == 2) {
         BezierSegment seg;
-        seg.p0 = points[0].position;
-        seg.p1 = points[1].position;
+        seg.p0 = stroke.getPosition(0);
+        seg.p1 = stroke.getPosition(1);
         seg.c1 = glm::mix(seg.p0, seg.p1, 0.33f);
         seg.c2 = glm::mix(seg.p0, seg.p1, 0.67f);
-        seg.widthStart = points[0].pressure * stroke.getBaseWidth();
-        seg.widthEnd = points[1].pressure * stroke.getBaseWidth();
+        seg.widthStart = pressure[0] * baseWidth;
+        seg.widthEnd = pressure[1] * baseWidth;
         segments.push_back(seg);
         return segments;
     }
     
-    // Use Catmull-Rom to create smooth Bézier curves
-    for (size_t i = 0; i < points.size() - 1; ++i) {
-        BezierSegment seg;
+    // Use Catmull-Rom to create smooth Bézier curves. Control points come from
+    // the vectorized kernel over the x/y arrays; the segments are then assembled
+    const size_t count = pointCount - 1;
+    std::vector<float> controls(count * 4);
+    float* c1x = controls.data();
+    float* c1y = c1x + count;
+    float* c2x = c1y + count;
+    float* c2y = c2x + count;
+    StrokeKernels::catmullRomControlPoints(x, y, pointCount, tension, c1x, c1y, c2x, c2y);
+    
+    segments.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        BezierSegment& seg = segments[i];
+        seg.p0 = glm::vec2(x[i], y[i]);
+        seg.p1 = glm::vec2(x[i + 1], y[i + 1]);
+        seg.c1 = glm::vec2(c1x[i], c1y[i]);
+        seg.c2 = glm::vec2(c2x[i], c2y[i]);
+        seg.widthStart = pressure[i] * baseWidth;
+        seg.widthEnd = pressure[i + 1] * baseWidth;
+    }
+    
+    return segments;
+}
+
+size_t BezierSmoother::smoothIncremental(const Stroke& stroke, std::vector<BezierSegment>& segments,
+                                         float tension) {
+    const size_t pointCount = stroke.getPointCount();
+    
+    // Short strokes use the special cases in smooth(); a stroke that shrank
+    // (or segments from another stroke) cannot be patched either
+    if (pointCount <= 3 || segments.size() < 2 || segments.size() > pointCount - 1) {
+        segments = smooth(stroke, tension);
+        return 0;
+    }
+    
+    // Segment i depends on points i-1 .. i+2. A new point at the end changes
+    // the previous last segment and adds new ones; an input filter may also
+    // have replaced the old last point, which reaches one segment further back
+    const StrokeView view(stroke);
+    size_t firstChanged = segments.size() - 2;
+    segments.resize(firstChanged);
+    for (size_t i = firstChanged; i < pointCount - 1; ++i) {
+        segments.push_back(catmullRomSegment(view, i, tension));
+    }
+    
+    return firstChanged;
+}
+
+namespace {
+
+// Schneider, "An Algorithm for Automatically Fitting Digitized Curves"
+// (Graphics Gems, 1990). Spans of points are fitted with one cubic each and
+// split at the worst point until every cubic is within tolerance.
+struct CurveFitter {
+    std::vector<glm::vec2> points;
+    std::vector<float> pressures;
+    std::vector<float> params;  // Per point of the span being fitted, 0..1
+    float halfWidth = 0.0f;
+    
+    static constexpr int MAX_REPARAMETERIZATIONS = 4;
+    
+    struct Span {
+        size_t first;
+        size_t last;
+        glm::vec2 startTangent;  // Unit, pointing into the span
+        glm::vec2 endTangent;
+    };
+    
+    void chordLengthParameters(size_t first, size_t last) {
+        params.assign(last - first + 1, 0.0f);
+        for (size_t i = first + 1; i <= last; ++i) {
+            params[i - first] = params[i - first - 1] + glm::distance(points[i], points[i - 1]);
+        }
+        const float length = params.back();
+        for (float& u : params) u /= length;
+    }
+    
+    // Least-squares tangent lengths for fixed endpoints and tangent directions
+    BezierSegment generate(const Span& span) const {
+        const glm::vec2 p0 = points[span.first];
+        const glm::vec2 p3 = points[span.last];
+        float c00 = 0.0f, c01 = 0.0f, c11 = 0.0f, x0 = 0.0f, x1 = 0.0f;
+        for (size_t i = span.first; i <= span.last; ++i) {
+            const float u = params[i - span.first];
+            const float v = 1.0f - u;
+            const float b0 = v * v * v, b1 = 3.0f * u * v * v, b2 = 3.0f * u * u * v, b3 = u * u * u;
+            const glm::vec2 a1 = span.startTangent * b1;
+            const glm::vec2 a2 = span.endTangent * b2;
+            c00 += glm::dot(a1, a1);
+            c01 += glm::dot(a1, a2);
+            c11 += glm::dot(a2, a2);
+            const glm::vec2 rest = points[i] - (p0 * (b0 + b1) + p3 * (b2 + b3));
+            x0 += glm::dot(a1, rest);
+            x1 += glm::dot(a2, rest);
+        }
         
-        const glm::vec2& p0 = points[i].position;
-        const glm::vec2& p1 = points[i + 1].position;
+        const float det = c00 * c11 - c01 * c01;
+        float alpha1 = (std::abs(det) > 1e-12f) ? (x0 * c11 - x1 * c01) / det : 0.0f;
+        float alpha2 = (std::abs(det) > 1e-12f) ? (c00 * x1 - c01 * x0) / det : 0.0f;
         
-        seg.p0 = p0;
-        seg.p1 = p1;
+        // Degenerate or backwards solutions, and handles reaching past each
+        // other (a loop): fall back to a third of the chord
+        const glm::vec2 line = p3 - p0;
+        const float chord = glm::length(line);
+        if (alpha1 < chord * 1e-6f || alpha2 < chord * 1e-6f ||
+            glm::dot(span.startTangent, line) * alpha1 - glm::dot(span.endTangent, line) * alpha2 > chord * chord) {
+            alpha1 = alpha2 = chord / 3.0f;
+        }
         
-        // Calculate control points using Catmull-Rom approach
-        glm::vec2 prevPos = (i > 0) ? points[i - 1].position : p0;
-        glm::vec2 nextPos = (i + 2 < points.size()) ? points[i + 2].position : p1;
+        BezierSegment segment;
+        segment.p0 = p0;
+        segment.c1 = p0 + span.startTangent * alpha1;
+        segment.c2 = p3 + span.endTangent * alpha2;
+        segment.p1 = p3;
+        segment.widthStart = pressures[span.first];
+        segment.widthEnd = pressures[span.last];
+        return segment;
+    }
+    
+    // Largest distance of an inner point from the curve (or of its half
+    // width from the interpolated one), and the point where it occurs
+    float maxError(const Span& span, const BezierSegment& segment, size_t& worstIndex) const {
+        float worst = 0.0f;
+        worstIndex = (span.first + span.last) / 2;
+        for (size_t i = span.first + 1; i < span.last; ++i) {
+            const float u = params[i - span.first];
+            const float position = glm::distance(BezierSmoother::evaluateCubic(segment, u), points[i]);
+            const float width = std::abs(pressures[i] - glm::mix(segment.widthStart, segment.widthEnd, u)) * halfWidth;
+            const float error = std::max(position, width);
+            if (error > worst) {
+                worst = error;
+                worstIndex = i;
+            }
+        }
+        return worst;
+    }
+    
+    // One Newton step per point towards the closest point on the curve;
+    // false when the parameters no longer follow the point order
+    bool reparameterize(const Span& span, const BezierSegment& segment) {
+        const glm::vec2 d1[3] = {(segment.c1 - segment.p0) * 3.0f, (segment.c2 - segment.c1) * 3.0f,
+                                 (segment.p1 - segment.c2) * 3.0f};
+        const glm::vec2 d2[2] = {(d1[1] - d1[0]) * 2.0f, (d1[2] - d1[1]) * 2.0f};
+        for (size_t i = span.first + 1; i < span.last; ++i) {
+            float& u = params[i - span.first];
+            const float v = 1.0f - u;
+            const glm::vec2 offset = BezierSmoother::evaluateCubic(segment, u) - points[i];
+            const glm::vec2 first = d1[0] * (v * v) + d1[1] * (2.0f * u * v) + d1[2] * (u * u);
+            const glm::vec2 second = d2[0] * v + d2[1] * u;
+            const float denominator = glm::dot(first, first) + glm::dot(offset, second);
+            if (std::abs(denominator) > 1e-12f) {
+                u = std::clamp(u - glm::dot(offset, first) / denominator, 0.0f, 1.0f);
+            }
+        }
+        return std::is_sorted(params.begin(), params.end());
+    }
+    
+    // Fits the span or splits it; returns true when `segment` holds the fit
+    bool fit(const Span& span, float tolerance, BezierSegment& segment, size_t& split) {
+        if (span.last - span.first == 1) {
+            const float third = glm::distance(points[span.first], points[span.last]) / 3.0f;
+            segment.p0 = points[span.first];
+            segment.c1 = segment.p0 + span.startTangent * third;
+            segment.p1 = points[span.last];
+            segment.c2 = segment.p1 + span.endTangent * third;
+            segment.widthStart = pressures[span.first];
+            segment.widthEnd = pressures[span.last];
+            return true;
+        }
         
-        // Tangent at p0
-        glm::vec2 tangent0 = (p1 - prevPos) * tension;
-        // Tangent at p1
-        glm::vec2 tangent1 = (nextPos - p0) * tension;
+        chordLengthParameters(span.first, span.last);
+        segment = generate(span);
+        float error = maxError(span, segment, split);
         
-        // Convert to Bézier control points
-        seg.c1 = p0 + tangent0 / 3.0f;
-        seg.c2 = p1 - tangent1 / 3.0f;
+        // Close misses are often fixed by better parameters alone
+        for (int i = 0; error > tolerance && error < tolerance * 4.0f && i < MAX_REPARAMETERIZATIONS; ++i) {
+            if (!reparameterize(span, segment)) {
+                break;
+            }
+            segment = generate(span);
+            error = maxError(span, segment, split);
+        }
+        return error <= tolerance;
+    }
+};
+
+StrokePoint interpolatePoint(const StrokeView& stroke, size_t a, size_t b, float t, const glm::vec2& position) {
+    const StrokePoint pa = stroke.getPoint(a);
+    const StrokePoint pb = stroke.getPoint(b);
+    return StrokePoint(position, glm::mix(pa.pressure, pb.pressure, t), glm::mix(pa.tiltX, pb.tiltX, t),
+                       glm::mix(pa.tiltY, pb.tiltY, t), glm::mix(pa.timestamp, pb.timestamp, t));
+}
+
+} // namespace
+
+std::vector<StrokePoint> BezierSmoother::fitCubics(const StrokeView& stroke, float tolerance) {
+    // Repeated positions have no tangent; fit the distinct ones
+    std::vector<size_t> sources;
+    sources.reserve(stroke.getPointCount());
+    for (size_t i = 0; i < stroke.getPointCount(); ++i) {
+        if (sources.empty() || stroke.getPosition(i) != stroke.getPosition(sources.back())) {
+            sources.push_back(i);
+        }
+    }
+    if (sources.size() < 2) {
+        return {};
+    }
+    
+    CurveFitter fitter;
+    fitter.halfWidth = stroke.getBaseWidth() * 0.5f;
+    for (size_t source : sources) {
+        fitter.points.push_back(stroke.getPosition(source));
+        fitter.pressures.push_back(stroke.getPressure()[source]);
+    }
+    
+    const size_t last = sources.size() - 1;
+    const glm::vec2 startTangent = glm::normalize(fitter.points[1] - fitter.points[0]);
+    const glm::vec2 endTangent = glm::normalize(fitter.points[last - 1] - fitter.points[last]);
+    
+    // Left halves are popped first, so curves come out in stroke order
+    std::vector<CurveFitter::Span> pending{{0, last, startTangent, endTangent}};
+    std::vector<StrokePoint> controlPoints{stroke.getPoint(sources.front())};
+    while (!pending.empty()) {
+        const CurveFitter::Span span = pending.back();
+        pending.pop_back();
         
-        // Width based on pressure
-        seg.widthStart = points[i].pressure * stroke.getBaseWidth();
-        seg.widthEnd = points[i + 1].pressure * stroke.getBaseWidth();
+        BezierSegment segment;
+        size_t split = 0;
+        if (fitter.fit(span, tolerance, segment, split)) {
+            const size_t a = sources[span.first];
+            const size_t b = sources[span.last];
+            controlPoints.push_back(interpolatePoint(stroke, a, b, 1.0f / 3.0f, segment.c1));
+            controlPoints.push_back(interpolatePoint(stroke, a, b, 2.0f / 3.0f, segment.c2));
+            controlPoints.push_back(stroke.getPoint(b));
+            continue;
+        }
         
-        segments.push_back(seg);
+        // Split at the worst point, with a shared tangent so the halves join smoothly
+        glm::vec2 center = fitter.points[split - 1] - fitter.points[split + 1];
+        if (glm::dot(center, center) < 1e-12f) {
+            center = fitter.points[split - 1] - fitter.points[split];
+        }
+        center = glm::normalize(center);
+        pending.push_back({split, span.last, -center, span.endTangent});
+        pending.push_back({span.first, split, span.startTangent, center});
     }
     
-    return segments;
+    return controlPoints;
+}
+
+BezierSegment BezierSmoother::catmullRomSegment(const StrokeView& stroke, size_t i, float tension) {
+    BezierSegment seg;
+    const size_t pointCount = stroke.getPointCount();
+    
+    const glm::vec2 p0 = stroke.getPosition(i);
+    const glm::vec2 p1 = stroke.getPosition(i + 1);
+    
+    seg.p0 = p0;
+    seg.p1 = p1;
+    
+    // Calculate control points using Catmull-Rom approach
+    glm::vec2 prevPos = (i > 0) ? stroke.getPosition(i - 1) : p0;
+    glm::vec2 nextPos = (i + 2 < pointCount) ? stroke.getPosition(i + 2) : p1;
+    
+    // Tangent at p0
+    glm::vec2 tangent0 = (p1 - prevPos) * tension;
+    // Tangent at p1
+    glm::vec2 tangent1 = (nextPos - p0) * tension;
+    
+    // Convert to Bézier control points
+    seg.c1 = p0 + tangent0 / 3.0f;
+    seg.c2 = p1 - tangent1 / 3.0f;
+    
+    // Width based on pressure
+    seg.widthStart = stroke.getPressure()[i] * stroke.getBaseWidth();
+    seg.widthEnd = stroke.getPressure()[i + 1] * stroke.getBaseWidth();
+    
+    return seg;
 }
 
 glm::vec2 BezierSmoother::evaluateCubic(const BezierSegment& segment, float t) {
@@ -102,36 +370,25 @@ std::vector<glm::vec2> BezierSmoother::tesselate(const std::vector<BezierSegment
 std::vector<glm::vec2> BezierSmoother::generateTriangleStrip(const std::vector<BezierSegment>& segments,
                                                               float baseWidth,
                                                               int pointsPerSegment) {
-    std::vector<glm::vec2> vertices;
-    
     if (segments.empty()) {
-        return vertices;
+        return {};
     }
     
     // Check if this is a single point (degenerate segment where p0 == p1)
     if (segments.size() == 1) {
         float distance = glm::length(segments[0].p1 - segments[0].p0);
-        std::cout << "Single segment, distance: " << distance << std::endl;
+        VS_TRACE(Smoothing, "Single segment, distance: " << distance);
         
         if (distance < 0.001f) {
             // Draw a circle for a single click
-            std::cout << "Drawing dot (circle)" << std::endl;
-            glm::vec2 center = segments[0].p0;
-            float halfWidth = baseWidth * 0.5f;
-            const int circleSegments = 32;
-            
-            for (int i = 0; i <= circleSegments; ++i) {
-                float angle = (static_cast<float>(i) / static_cast<float>(circleSegments)) * 2.0f * M_PI;
-                glm::vec2 point = center + glm::vec2(cosf(angle), sinf(angle)) * halfWidth;
-                vertices.push_back(center);  // Center point
-                vertices.push_back(point);   // Edge point
-            }
-            
+            VS_TRACE(Smoothing, "Drawing dot (circle)");
+            std::vector<glm::vec2> vertices;
+            appendCircle(vertices, segments[0].p0, baseWidth * 0.5f, 32);
             return vertices;
         }
     }
     
-    std::cout << "Drawing line with " << segments.size() << " segments (with round caps)" << std::endl;
+    VS_TRACE(Smoothing, "Drawing line with " << segments.size() << " segments (with round caps)");
     
     // First, tesselate to get centerline points
     std::vector<glm::vec2> centerPoints;
@@ -142,70 +399,146 @@ std::vector<glm::vec2> BezierSmoother::generateTriangleStrip(const std::vector<B
         }
     }
     
-    if (centerPoints.empty()) {
+    const int capSegments = 16;
+    auto vertices = buildStrip(centerPoints, baseWidth * 0.5f, capSegments, 32);
+    
+    VS_TRACE(Smoothing, "Total vertices with caps: " << vertices.size()
+            << " (centerPoints: " << centerPoints.size() << ", capSegments: " << capSegments << ")");
+    
+    return vertices;
+}
+
+int BezierSmoother::segmentSampleCount(const BezierSegment& segment, float halfWidth,
+                                       float pixelsPerUnit, float tolerance) {
+    // Wang's bound: a cubic split into n equal steps in t deviates from its
+    // chords by at most (3/4) * M / n^2, M = largest second difference
+    float m = std::max(glm::length(segment.p0 - 2.0f * segment.c1 + segment.c2),
+                       glm::length(segment.c1 - 2.0f * segment.c2 + segment.p1)) * pixelsPerUnit;
+    float steps = std::sqrt(0.75f * m / tolerance);
+    
+    // The outline sits halfWidth away from the centerline, so it sweeps a larger
+    // arc when the segment turns: sagitta r * theta^2 / (8 n^2) <= tolerance
+    glm::vec2 startTangent = segment.c1 - segment.p0;
+    glm::vec2 endTangent = segment.p1 - segment.c2;
+    float startLength = glm::length(startTangent);
+    float endLength = glm::length(endTangent);
+    if (startLength > 0.0001f && endLength > 0.0001f) {
+        float cosTurn = glm::clamp(glm::dot(startTangent, endTangent) / (startLength * endLength), -1.0f, 1.0f);
+        float turn = std::acos(cosTurn);
+        float radius = halfWidth * pixelsPerUnit;
+        steps = std::max(steps, turn * std::sqrt(radius / (8.0f * tolerance)));
+    }
+    
+    int count = static_cast<int>(std::ceil(steps)) + 1;
+    return std::clamp(count, 2, MAX_ADAPTIVE_SAMPLES);
+}
+
+int BezierSmoother::circleSegmentCount(float radiusPixels, float tolerance) {
+    // Largest chord sagitta r * (1 - cos(pi / n)) must stay under tolerance
+    if (radiusPixels <= tolerance) {
+        return MIN_CIRCLE_SEGMENTS;
+    }
+    float n = static_cast<float>(M_PI) / std::acos(1.0f - tolerance / radiusPixels);
+    return std::clamp(static_cast<int>(std::ceil(n)), MIN_CIRCLE_SEGMENTS, MAX_CIRCLE_SEGMENTS);
+}
+
+std::vector<glm::vec2> BezierSmoother::generateTriangleStripAdaptive(const std::vector<BezierSegment>& segments,
+                                                                      float baseWidth,
+                                                                      float pixelsPerUnit,
+                                                                      float tolerance) {
+    std::vector<glm::vec2> vertices;
+    if (segments.empty()) {
         return vertices;
     }
     
     float halfWidth = baseWidth * 0.5f;
+    int roundSegments = circleSegmentCount(halfWidth * pixelsPerUnit, tolerance);
+    
+    if (segments.size() == 1 && glm::length(segments[0].p1 - segments[0].p0) < 0.001f) {
+        appendCircle(vertices, segments[0].p0, halfWidth, roundSegments);
+        return vertices;
+    }
+    
+    // Centerline with per-segment sample counts; shared endpoints are kept
+    // once so straight runs collapse to a handful of points
+    std::vector<glm::vec2> centerPoints;
+    for (const auto& segment : segments) {
+        int samples = segmentSampleCount(segment, halfWidth, pixelsPerUnit, tolerance);
+        int first = centerPoints.empty() ? 0 : 1;
+        for (int i = first; i < samples; ++i) {
+            float t = static_cast<float>(i) / static_cast<float>(samples - 1);
+            centerPoints.push_back(evaluateCubic(segment, t));
+        }
+    }
+    
+    return buildStrip(centerPoints, halfWidth, roundSegments, roundSegments);
+}
+
+glm::vec2 BezierSmoother::centerlineNormal(const std::vector<glm::vec2>& centerPoints, size_t i) {
+    glm::vec2 tangent;
+    
+    // Calculate tangent direction
+    if (i == 0) {
+        tangent = centerPoints[i + 1] - centerPoints[i];
+    } else if (i == centerPoints.size() - 1) {
+        tangent = centerPoints[i] - centerPoints[i - 1];
+    } else {
+        tangent = centerPoints[i + 1] - centerPoints[i - 1];
+    }
+    
+    // Normalize tangent
+    float length = glm::length(tangent);
+    if (length > 0.0001f) {
+        tangent /= length;
+    } else {
+        tangent = glm::vec2(1.0f, 0.0f);
+    }
+    
+    // Calculate perpendicular normal (rotate tangent 90 degrees)
+    return glm::vec2(-tangent.y, tangent.x);
+}
+
+void BezierSmoother::appendCircle(std::vector<glm::vec2>& vertices, const glm::vec2& center,
+                               float radius, int circleSegments) {
+    for (int i = 0; i <= circleSegments; ++i) {
+        float angle = (static_cast<float>(i) / static_cast<float>(circleSegments)) * 2.0f * M_PI;
+        glm::vec2 point = center + glm::vec2(cosf(angle), sinf(angle)) * radius;
+        vertices.push_back(center);  // Center point
+        vertices.push_back(point);   // Edge point
+    }
+}
+
+std::vector<glm::vec2> BezierSmoother::buildStrip(const std::vector<glm::vec2>& centerPoints,
+                                                  float halfWidth,
+                                                  int capSegments,
+                                                  int dotSegments) {
+    std::vector<glm::vec2> vertices;
+    
+    if (centerPoints.empty()) {
+        return vertices;
+    }
     
     // Special case: very few points (shouldn't happen now but keep as fallback)
     if (centerPoints.size() == 1) {
         // Draw a circle for a single click
-        glm::vec2 center = centerPoints[0];
-        const int circleSegments = 32;
-        
-        for (int i = 0; i <= circleSegments; ++i) {
-            float angle = (static_cast<float>(i) / static_cast<float>(circleSegments)) * 2.0f * M_PI;
-            glm::vec2 point = center + glm::vec2(cosf(angle), sinf(angle)) * halfWidth;
-            vertices.push_back(center);  // Center point
-            vertices.push_back(point);   // Edge point
-        }
-        
+        appendCircle(vertices, centerPoints[0], halfWidth, dotSegments);
         return vertices;
     }
     
     // Reserve space for triangle strip (2 vertices per center point + round caps)
-    vertices.reserve(centerPoints.size() * 2 + 64);
+    vertices.reserve(centerPoints.size() * 2 + 4 * (capSegments + 1) + 5);
     
     // Calculate tangents and normals for all points
     std::vector<glm::vec2> normals;
     normals.reserve(centerPoints.size());
     
     for (size_t i = 0; i < centerPoints.size(); ++i) {
-        glm::vec2 tangent;
-        
-        // Calculate tangent direction
-        if (i == 0) {
-            tangent = centerPoints[i + 1] - centerPoints[i];
-        } else if (i == centerPoints.size() - 1) {
-            tangent = centerPoints[i] - centerPoints[i - 1];
-        } else {
-            tangent = centerPoints[i + 1] - centerPoints[i - 1];
-        }
-        
-        // Normalize tangent
-        float length = glm::length(tangent);
-        if (length > 0.0001f) {
-            tangent /= length;
-        } else {
-            tangent = glm::vec2(1.0f, 0.0f);
-        }
-        
-        // Calculate perpendicular normal (rotate tangent 90 degrees)
-        glm::vec2 normal(-tangent.y, tangent.x);
-        normals.push_back(normal);
+        normals.push_back(centerlineNormal(centerPoints, i));
     }
     
     // Add round cap at start as a circle (triangle fan)
-    const int capSegments = 16;
     glm::vec2 startCenter = centerPoints[0];
-    
-    for (int i = 0; i <= capSegments; ++i) {
-        float angle = 2.0f * M_PI * static_cast<float>(i) / static_cast<float>(capSegments);
-        glm::vec2 point = startCenter + glm::vec2(cosf(angle), sinf(angle)) * halfWidth;
-        vertices.push_back(startCenter);
-        vertices.push_back(point);
-    }
+    appendCircle(vertices, startCenter, halfWidth, capSegments);
     
     // Add degenerate triangles to connect cap to body
     glm::vec2 startLeft = startCenter - normals[0] * halfWidth;
@@ -232,15 +565,7 @@ std::vector<glm::vec2> BezierSmoother::generateTriangleStrip(const std::vector<B
     vertices.push_back(endCenter);
     
     // Add round cap at end as a circle (triangle fan)
-    for (int i = 0; i <= capSegments; ++i) {
-        float angle = 2.0f * M_PI * static_cast<float>(i) / static_cast<float>(capSegments);
-        glm::vec2 point = endCenter + glm::vec2(cosf(angle), sinf(angle)) * halfWidth;
-        vertices.push_back(endCenter);
-        vertices.push_back(point);
-    }
-    
-    std::cout << "Total vertices with caps: " << vertices.size() 
-              << " (centerPoints: " << centerPoints.size() << ", capSegments: " << capSegments << ")" << std::endl;
+    appendCircle(vertices, endCenter, halfWidth, capSegments);
     
     return vertices;
 }
@@ -1,209 +1,660 @@
 #include "Canvas.h"
-#include <iostream>
+#include "StrokeKernels.h"
+#include "BezierSmoother.h"
+#include "SketchFormat.h"
+#include "MappedFile.h"
+#include "Log.h"
 #include <fstream>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 
 namespace VectorSketch {
 
-void Canvas::beginStroke(const glm::vec3& color, float width) {
+// Version 1 files store points as six packed floats, which is also StrokePoint's layout
+static_assert(sizeof(StrokePoint) == 6 * sizeof(float), "StrokePoint must match the on-disk point layout");
+
+namespace {
+// Points per column write when progress is reported (4 MB)
+constexpr uint64_t WRITE_CHUNK_POINTS = 1 << 20;
+
+// Reports done/total to a FileProgress whenever another percent is done
+class ProgressReporter {
+public:
+    ProgressReporter(const Canvas::FileProgress& progress, uint64_t total) : progress(progress), total(total) {}
+    
+    void update(uint64_t done) {
+        if (!progress || total == 0) return;
+        const uint64_t percent = done * 100 / total;
+        if (percent > lastPercent) {
+            lastPercent = percent;
+            progress(static_cast<float>(done) / static_cast<float>(total));
+        }
+    }
+    
+private:
+    const Canvas::FileProgress& progress;
+    uint64_t total;
+    uint64_t lastPercent = 0;
+};
+
+// Version 1: per stroke, a small header and a run of interleaved points
+bool readStreamedStrokes(std::istream& file, StrokePool& loaded, const Canvas::FileProgress& progress) {
+    // Read number of strokes
+    uint32_t numStrokes;
+    file.read(reinterpret_cast<char*>(&numStrokes), sizeof(numStrokes));
+    
+    std::vector<StrokePoint> points;
+    ProgressReporter reporter(progress, numStrokes);
+    
+    // Read each stroke
+    for (uint32_t i = 0; i < numStrokes; ++i) {
+        // Read color
+        glm::vec3 color;
+        file.read(reinterpret_cast<char*>(&color.r), sizeof(float));
+        file.read(reinterpret_cast<char*>(&color.g), sizeof(float));
+        file.read(reinterpret_cast<char*>(&color.b), sizeof(float));
+        
+        // Read base width
+        float width;
+        file.read(reinterpret_cast<char*>(&width), sizeof(float));
+        
+        // Read number of points
+        uint32_t numPoints;
+        file.read(reinterpret_cast<char*>(&numPoints), sizeof(numPoints));
+        if (!file) {
+            VS_ERROR(File, "Truncated file: stopped at stroke " << i << " of " << numStrokes);
+            return false;
+        }
+        
+        // Read the whole point run at once
+        points.resize(numPoints);
+        file.read(reinterpret_cast<char*>(points.data()), numPoints * sizeof(StrokePoint));
+        if (!file) {
+            VS_ERROR(File, "Truncated file: stopped at stroke " << i << " of " << numStrokes);
+            return false;
+        }
+        
+        loaded.append(points.data(), points.size(), color, width);
+        reporter.update(i + 1);
+    }
+    return true;
+}
+
+// Version 2: validate the layout and the stroke table, then copy each column
+// straight out of the mapping. Work is O(strokes) plus the bulk copies.
+bool readMappedStrokes(const uint8_t* data, size_t size, StrokePool& loaded, const Canvas::FileProgress& progress) {
+    using namespace SketchFormat;
+    
+    if (size < sizeof(HeaderV2)) {
+        VS_ERROR(File, "Truncated file: header incomplete");
+        return false;
+    }
+    HeaderV2 header;
+    std::memcpy(&header, data, sizeof(header));
+    
+    if (header.headerSize != sizeof(HeaderV2) || header.strokeRecordSize != sizeof(StrokeRecordV2)) {
+        VS_ERROR(File, "Invalid file format (unexpected record sizes)");
+        return false;
+    }
+    
+    // Every block must lie inside the file; the pool indexes points with 32 bits
+    const uint64_t fileSize = size;
+    if (header.pointCount > UINT32_MAX ||
+        header.strokeCount > (fileSize - sizeof(HeaderV2)) / sizeof(StrokeRecordV2) ||
+        header.strokeTableOffset > fileSize - header.strokeCount * sizeof(StrokeRecordV2) ||
+        header.strokeTableOffset % alignof(StrokeRecordV2) != 0) {
+        VS_ERROR(File, "Invalid file format (stroke table out of range)");
+        return false;
+    }
+    for (int column = 0; column < COLUMN_COUNT; ++column) {
+        uint64_t offset = header.columnOffsets[column];
+        if (offset % alignof(float) != 0 || offset > fileSize ||
+            header.pointCount > (fileSize - offset) / sizeof(float)) {
+            VS_ERROR(File, "Invalid file format (point data out of range)");
+            return false;
+        }
+    }
+    
+    const StrokeRecordV2* table = reinterpret_cast<const StrokeRecordV2*>(data + header.strokeTableOffset);
+    const size_t strokeCount = header.strokeCount;
+    ProgressReporter reporter(progress, header.strokeCount + header.pointCount);
+    
+    StrokeView::Columns columns;
+    const float** columnPointers[COLUMN_COUNT] = {
+        &columns.x, &columns.y, &columns.pressure, &columns.tiltX, &columns.tiltY, &columns.timestamp
+    };
+    for (int column = 0; column < COLUMN_COUNT; ++column) {
+        *columnPointers[column] = reinterpret_cast<const float*>(data + header.columnOffsets[column]);
+    }
+    if (!StrokeKernels::allFinite(columns.x, columns.y, header.pointCount)) {
+        VS_ERROR(File, "Invalid file format: non-finite point coordinates");
+        return false;
+    }
+    
+    // One pass over the stroke table validates it and gathers the
+    // per-stroke attributes; strokes must be stored back to back. Bounds
+    // are recomputed from the points rather than trusted: the spatial index
+    // and culling rely on them
+    std::vector<uint32_t> offsets(strokeCount + 1, 0);
+    std::vector<glm::vec3> colors(strokeCount);
+    std::vector<float> widths(strokeCount);
+    std::vector<BoundingBox> bounds(strokeCount);
+    std::vector<StrokeEncoding> encodings(strokeCount);
+    for (size_t i = 0; i < strokeCount; ++i) {
+        const StrokeRecordV2& record = table[i];
+        if (record.firstPoint != offsets[i] || record.pointCount > header.pointCount - record.firstPoint) {
+            VS_ERROR(File, "Invalid file format: stroke " << i << " points out of range");
+            return false;
+        }
+        offsets[i + 1] = offsets[i] + record.pointCount;
+        colors[i] = glm::vec3(record.color[0], record.color[1], record.color[2]);
+        widths[i] = record.baseWidth;
+        BoundingBox pointBounds = StrokeKernels::computeBounds(columns.x + offsets[i], columns.y + offsets[i],
+                                                               record.pointCount);
+        bounds[i] = pointBounds.inflated(record.baseWidth * 0.5f);
+        if (!(record.baseWidth >= 0.0f) || !bounds[i].isFinite()) {
+            VS_ERROR(File, "Invalid file format: stroke " << i << " has a negative or non-finite width");
+            return false;
+        }
+        encodings[i] = (record.flags & STROKE_FLAG_CUBIC) ? StrokeEncoding::Cubic : StrokeEncoding::Samples;
+        reporter.update(i + 1);
+    }
+    if (offsets[strokeCount] != header.pointCount) {
+        VS_ERROR(File, "Invalid file format: strokes cover " << offsets[strokeCount] << " of "
+                 << header.pointCount << " points");
+        return false;
+    }
+    
+    // Stored levels of detail are used when the file has them for this
+    // build's levels; they are rebuilt otherwise
+    StrokePool::LevelOfDetailColumns levels{};
+    const bool storedLevels = (header.lodLevels == StrokePool::LOD_LEVELS);
+    if (storedLevels) {
+        const uint64_t offsetCount = header.strokeCount * StrokePool::LOD_LEVELS + 1;
+        const uint64_t lodColumnBytes = columnBytes(header.lodPointCount);
+        if (header.lodPointCount > UINT32_MAX ||
+            header.lodOffsetsOffset % alignof(uint32_t) != 0 || header.lodOffsetsOffset > fileSize ||
+            offsetCount > (fileSize - header.lodOffsetsOffset) / sizeof(uint32_t) ||
+            header.lodColumnsOffset % alignof(float) != 0 || header.lodColumnsOffset > fileSize ||
+            (COLUMN_COUNT - 1) * lodColumnBytes + header.lodPointCount * sizeof(float) >
+                fileSize - header.lodColumnsOffset) {
+            VS_ERROR(File, "Invalid file format (levels of detail out of range)");
+            return false;
+        }
+        levels.offsets = reinterpret_cast<const uint32_t*>(data + header.lodOffsetsOffset);
+        bool ordered = levels.offsets[0] == 0 && levels.offsets[offsetCount - 1] == header.lodPointCount;
+        for (uint64_t k = 1; ordered && k < offsetCount; ++k) {
+            ordered = levels.offsets[k] >= levels.offsets[k - 1];
+        }
+        if (!ordered) {
+            VS_ERROR(File, "Invalid file format (level-of-detail offsets out of order)");
+            return false;
+        }
+        const float** lodColumnPointers[COLUMN_COUNT] = {
+            &levels.columns.x, &levels.columns.y, &levels.columns.pressure,
+            &levels.columns.tiltX, &levels.columns.tiltY, &levels.columns.timestamp
+        };
+        for (int column = 0; column < COLUMN_COUNT; ++column) {
+            *lodColumnPointers[column] = reinterpret_cast<const float*>(data + header.lodColumnsOffset +
+                                                                        column * lodColumnBytes);
+        }
+    }
+    
+    // Then each column is copied in one piece
+    loaded.reserve(strokeCount, header.pointCount);
+    loaded.appendColumns(columns, offsets.data(), strokeCount, colors.data(), widths.data(), bounds.data(),
+                         encodings.data(), storedLevels ? &levels : nullptr);
+    reporter.update(header.strokeCount + header.pointCount);
+    return true;
+}
+
+float distanceToSegment(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b) {
+    glm::vec2 ab = b - a;
+    float lengthSq = glm::dot(ab, ab);
+    float t = (lengthSq > 0.0f) ? glm::clamp(glm::dot(p - a, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+    return glm::length(p - (a + ab * t));
+}
+
+// Points along a stroke's centerline: the samples themselves, or points
+// about CURVE_SAMPLE_SPACING apart on the stored curves of fitted strokes
+constexpr float CURVE_SAMPLE_SPACING = 2.0f;
+constexpr int MAX_CURVE_SAMPLES = 256;
+
+void centerlinePoints(const StrokeView& stroke, std::vector<glm::vec2>& points) {
+    points.clear();
+    if (stroke.getEncoding() != StrokeEncoding::Cubic) {
+        for (size_t i = 0; i < stroke.getPointCount(); ++i) {
+            points.push_back(stroke.getPosition(i));
+        }
+        return;
+    }
+    
+    for (const BezierSegment& segment : BezierSmoother::smooth(stroke)) {
+        // The control polygon is never shorter than the curve
+        const float length = glm::distance(segment.p0, segment.c1) + glm::distance(segment.c1, segment.c2) +
+                             glm::distance(segment.c2, segment.p1);
+        const int steps = std::clamp(static_cast<int>(std::ceil(length / CURVE_SAMPLE_SPACING)), 1, MAX_CURVE_SAMPLES);
+        for (int i = points.empty() ? 0 : 1; i <= steps; ++i) {
+            points.push_back(BezierSmoother::evaluateCubic(segment, static_cast<float>(i) / steps));
+        }
+    }
+}
+}
+
+void Canvas::beginStroke(const glm::vec3& color, float width, const StrokeInputFilter& filter) {
+    dirty = true;
     currentStroke = std::make_shared<Stroke>();
     currentStroke->setColor(color);
     currentStroke->setBaseWidth(width);
+    currentStroke->setInputFilter(filter);
 }
 
 void Canvas::addPointToCurrentStroke(const StrokePoint& point) {
     if (currentStroke) {
         currentStroke->addPoint(point);
+        dirty = true;
     }
 }
 
 void Canvas::endStroke() {
     if (currentStroke && !currentStroke->isEmpty()) {
-        strokes.push_back(currentStroke);
+        Command command;
+        command.type = CommandType::AddStroke;
         
-        // Initialize history with first stroke if empty
-        if (history.empty()) {
-            std::vector<std::shared_ptr<Stroke>> initial;
-            history.push_back(initial);
-            historyIndex = 0;
+        // Keep the fitted curves only when they are smaller than the samples
+        std::vector<StrokePoint> controlPoints;
+        const float fitTolerance = currentStroke->getInputFilter().fitTolerance;
+        if (fitTolerance > 0.0f) {
+            controlPoints = BezierSmoother::fitCubics(*currentStroke, fitTolerance);
         }
-        
-        saveToHistory();  // Save state after completing stroke
+        if (!controlPoints.empty() && controlPoints.size() < currentStroke->getPointCount()) {
+            VS_TRACE(Canvas, "Fitted " << currentStroke->getPointCount() << " points into "
+                     << (controlPoints.size() - 1) / 3 << " curves");
+            command.strokes.append(controlPoints.data(), controlPoints.size(), currentStroke->getColor(),
+                                   currentStroke->getBaseWidth(), StrokeEncoding::Cubic);
+        } else {
+            command.strokes.append(*currentStroke);
+        }
+        applyCommand(command);
+        pushCommand(std::move(command));
     }
     currentStroke = nullptr;
+    dirty = true;
 }
 
 void Canvas::clear() {
-    strokes.clear();
     currentStroke = nullptr;
+    dirty = true;
     
-    // Initialize history if empty
-    if (history.empty()) {
-        std::vector<std::shared_ptr<Stroke>> initial;
-        history.push_back(initial);
-        historyIndex = 0;
+    // Clearing an empty canvas is not worth an undo step
+    if (strokes.empty()) {
+        selectedStrokes.clear();
+        return;
     }
     
-    saveToHistory();  // Save cleared state
+    Command command;
+    command.type = CommandType::Clear;
+    applyCommand(command);
+    pushCommand(std::move(command));
 }
 
-void Canvas::saveToHistory() {
-    // Remove any states after current index (when doing new action after undo)
-    if (historyIndex < history.size() - 1) {
-        history.erase(history.begin() + historyIndex + 1, history.end());
-    }
+void Canvas::addStrokes(StrokePool& added) {
+    if (added.empty()) return;
     
-    // Deep copy current strokes
-    std::vector<std::shared_ptr<Stroke>> snapshot;
-    for (const auto& stroke : strokes) {
-        auto strokeCopy = std::make_shared<Stroke>(*stroke);
-        snapshot.push_back(strokeCopy);
+    Command command;
+    command.type = CommandType::AddStrokes;
+    command.strokes.swap(added);
+    applyCommand(command);
+    VS_DEBUG(Canvas, "Added " << command.count << " strokes");
+    pushCommand(std::move(command));
+}
+
+void Canvas::setHistoryMemoryBudget(size_t bytes) {
+    historyBudget = bytes;
+    trimHistory();
+}
+
+void Canvas::pushCommand(Command command) {
+    // A new action discards everything that could have been redone
+    while (history.size() > historyIndex) {
+        historyBytes -= history.back().bytes;
+        history.pop_back();
+    }
+    if (!history.empty()) {
+        history.back().open = false;
     }
     
-    // Add to history
-    history.push_back(snapshot);
+    command.bytes = commandBytes(command);
+    historyBytes += command.bytes;
+    history.push_back(std::move(command));
+    historyIndex = history.size();
     
-    // Limit history size
-    if (history.size() > MAX_HISTORY) {
-        history.erase(history.begin());
-    } else {
-        historyIndex++;
-    }
+    trimHistory();
     
-    // Ensure index is within bounds
-    if (historyIndex >= history.size()) {
-        historyIndex = history.size() - 1;
+    VS_DEBUG(History, "Saved to history: " << strokes.size() << " strokes, index=" << historyIndex
+            << ", total=" << history.size() << ", " << historyBytes << " bytes");
+}
+
+void Canvas::trimHistory() {
+    // Oldest undo steps go first; the most recent action always stays undoable
+    while (historyBytes > historyBudget && history.size() > 1) {
+        if (historyIndex > 1) {
+            historyBytes -= history.front().bytes;
+            history.pop_front();
+            historyIndex--;
+        } else if (history.size() > historyIndex) {
+            historyBytes -= history.back().bytes;
+            history.pop_back();
+        } else {
+            break;
+        }
     }
-    
-    std::cout << "Saved to history: " << strokes.size() << " strokes, index=" << historyIndex << ", total=" << history.size() << std::endl;
 }
 
-void Canvas::loadFromHistory(size_t index) {
-    if (index >= history.size()) return;
-    
-    strokes.clear();
+size_t Canvas::commandBytes(const Command& command) {
+    return sizeof(Command) + command.indices.capacity() * sizeof(size_t) +
+           command.strokes.getMemoryUsage();
+}
+
+void Canvas::applyCommand(Command& command) {
+    switch (command.type) {
+        case CommandType::AddStroke: {
+            // The command holds just this stroke; release its columns rather
+            // than keep their capacity alive in the history
+            size_t index = strokes.appendFrom(command.strokes, 0);
+            command.strokes = StrokePool();
+            spatialIndex.insert(index, strokes.getBounds(index));
+            addDamage(strokes.getBounds(index));
+            break;
+        }
+        case CommandType::AddStrokes: {
+            // While the strokes are on the canvas the command only keeps their count
+            command.count = command.strokes.size();
+            const size_t first = strokes.appendRange(command.strokes, 0, command.count);
+            command.strokes = StrokePool();
+            
+            const BoundingBox* added = strokes.getAllBounds().data() + first;
+            spatialIndex.insertRange(first, added, command.count);
+            BoundingBox area;
+            for (size_t i = 0; i < command.count; ++i) {
+                area.expand(added[i]);
+            }
+            addDamage(area);
+            break;
+        }
+        case CommandType::Clear:
+        case CommandType::Load:
+            swapStrokes(command.strokes);
+            break;
+        case CommandType::MoveSelection:
+            for (size_t idx : command.indices) {
+                addDamage(strokes.getBounds(idx));
+                strokes.translate(idx, command.delta);
+                spatialIndex.update(idx, strokes.getBounds(idx));
+                addDamage(strokes.getBounds(idx));
+            }
+            break;
+    }
+}
+
+void Canvas::revertCommand(Command& command) {
+    switch (command.type) {
+        case CommandType::AddStroke: {
+            size_t index = strokes.size() - 1;
+            addDamage(strokes.getBounds(index));
+            spatialIndex.remove(index);
+            selectedStrokes.erase(index);
+            command.strokes.appendFrom(strokes, index);
+            strokes.popBack();
+            break;
+        }
+        case CommandType::AddStrokes: {
+            const size_t first = strokes.size() - command.count;
+            BoundingBox area;
+            for (size_t i = strokes.size(); i-- > first;) {
+                area.expand(strokes.getBounds(i));
+                spatialIndex.remove(i);
+            }
+            addDamage(area);
+            selectedStrokes.erase(selectedStrokes.lower_bound(first), selectedStrokes.end());
+            command.strokes.appendRange(strokes, first, strokes.size());
+            strokes.truncate(first);
+            break;
+        }
+        case CommandType::Clear:
+        case CommandType::Load:
+            swapStrokes(command.strokes);
+            break;
+        case CommandType::MoveSelection:
+            for (size_t idx : command.indices) {
+                addDamage(strokes.getBounds(idx));
+                strokes.translate(idx, -command.delta);
+                spatialIndex.update(idx, strokes.getBounds(idx));
+                addDamage(strokes.getBounds(idx));
+            }
+            break;
+    }
+}
+
+void Canvas::swapStrokes(StrokePool& other) {
+    strokes.swap(other);
+    selectedStrokes.clear();
+    rebuildSpatialIndex();
+    addFullDamage();
+}
+
+void Canvas::addDamage(const BoundingBox& area) {
+    damage.expand(area);
+    dirty = true;
+}
+
+void Canvas::addFullDamage() {
+    fullDamage = true;
+    dirty = true;
+}
+
+void Canvas::rebuildSpatialIndex() {
+    spatialIndex.clear();
+    for (size_t i = 0; i < strokes.size(); ++i) {
+        spatialIndex.insert(i, strokes.getBounds(i));
+    }
+}
+
+std::vector<size_t> Canvas::queryStrokes(const BoundingBox& area) const {
+    std::vector<size_t> result;
+    spatialIndex.queryRect(area, result);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool Canvas::hitTest(const glm::vec2& worldPos, float tolerance, size_t& strokeIndex) const {
+    BoundingBox area(worldPos - glm::vec2(tolerance), worldPos + glm::vec2(tolerance));
+    std::vector<size_t> candidates = queryStrokes(area);
     
-    // Deep copy from history
-    for (const auto& stroke : history[index]) {
-        auto strokeCopy = std::make_shared<Stroke>(*stroke);
-        strokes.push_back(strokeCopy);
+    // Topmost stroke wins
+    std::vector<glm::vec2> points;
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        const StrokeView stroke = strokes.view(*it);
+        centerlinePoints(stroke, points);
+        size_t pointCount = points.size();
+        float reach = stroke.getBaseWidth() * 0.5f + tolerance;
+        
+        if (pointCount == 1 && glm::length(worldPos - points[0]) <= reach) {
+            strokeIndex = *it;
+            return true;
+        }
+        for (size_t i = 1; i < pointCount; ++i) {
+            if (distanceToSegment(worldPos, points[i - 1], points[i]) <= reach) {
+                strokeIndex = *it;
+                return true;
+            }
+        }
     }
+    return false;
 }
 
 void Canvas::undo() {
-    if (history.empty() || historyIndex == 0) {
-        std::cout << "Cannot undo: history empty or at beginning" << std::endl;
+    if (!canUndo()) {
+        VS_DEBUG(History, "Cannot undo: history empty or at beginning");
         return;
     }
-    if (!canUndo()) return;
     
     historyIndex--;
+    Command& command = history[historyIndex];
+    command.open = false;
+    revertCommand(command);
     
-    // Bounds check
-    if (historyIndex >= history.size()) {
-        std::cout << "Undo: Index out of bounds, resetting" << std::endl;
-        historyIndex = 0;
-        return;
-    }
+    // An undone add now holds its stroke, so its footprint changes
+    historyBytes -= command.bytes;
+    command.bytes = commandBytes(command);
+    historyBytes += command.bytes;
     
-    std::cout << "Undo: Moving to history index " << historyIndex << " (total: " << history.size() << ")" << std::endl;
-    loadFromHistory(historyIndex);
+    VS_DEBUG(History, "Undo: Moving to history index " << historyIndex << " (total: " << history.size() << ")");
 }
 
 void Canvas::redo() {
-    if (history.empty()) {
-        std::cout << "Cannot redo: history empty" << std::endl;
+    if (!canRedo()) {
+        VS_DEBUG(History, "Cannot redo: nothing to redo");
         return;
     }
-    if (!canRedo()) return;
     
+    Command& command = history[historyIndex];
+    applyCommand(command);
     historyIndex++;
     
-    // Bounds check
-    if (historyIndex >= history.size()) {
-        std::cout << "Redo: Index out of bounds, capping" << std::endl;
-        historyIndex = history.size() - 1;
-        return;
-    }
+    historyBytes -= command.bytes;
+    command.bytes = commandBytes(command);
+    historyBytes += command.bytes;
     
-    std::cout << "Redo: Moving to history index " << historyIndex << " (total: " << history.size() << ")" << std::endl;
-    loadFromHistory(historyIndex);
+    VS_DEBUG(History, "Redo: Moving to history index " << historyIndex << " (total: " << history.size() << ")");
 }
 
-void Canvas::render(VectorRenderer& renderer) {
-    // Render all completed strokes
-    for (const auto& stroke : strokes) {
-        renderer.renderStroke(*stroke);
-    }
-    
-    // Render current stroke being drawn
-    if (currentStroke && !currentStroke->isEmpty()) {
-        renderer.renderStroke(*currentStroke);
-    }
+bool Canvas::saveToFile(const std::string& filepath) {
+    return writeStrokes(strokes, filepath);
 }
 
-bool Canvas::saveToFile(const std::string& filepath) {
+bool Canvas::writeStrokes(const StrokePool& strokes, const std::string& filepath, const FileProgress& progress) {
+    using namespace SketchFormat;
+    
     std::ofstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
-        std::cerr << "Failed to open file for writing: " << filepath << std::endl;
+        VS_ERROR(File, "Failed to open file for writing: " << filepath);
         return false;
     }
     
     try {
-        // Write header: magic number + version
-        const char magic[4] = {'M', 'M', 'V', 'S'}; // Mind Map Vector Sketch
-        file.write(magic, 4);
+        const StrokePointArrays& points = strokes.getPointArrays();
+        const uint64_t pointCount = points.size();
         
-        uint32_t version = 1;
-        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        // Layout: header | stroke table | six aligned point columns
+        HeaderV2 header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.version = VERSION_MAPPED;
+        header.headerSize = sizeof(HeaderV2);
+        header.strokeRecordSize = sizeof(StrokeRecordV2);
+        header.strokeCount = strokes.size();
+        header.pointCount = pointCount;
+        header.strokeTableOffset = sizeof(HeaderV2);
         
-        // Write number of strokes
-        uint32_t numStrokes = static_cast<uint32_t>(strokes.size());
-        file.write(reinterpret_cast<const char*>(&numStrokes), sizeof(numStrokes));
+        uint64_t offset = alignUp(header.strokeTableOffset + strokes.size() * sizeof(StrokeRecordV2), COLUMN_ALIGNMENT);
+        for (int column = 0; column < COLUMN_COUNT; ++column) {
+            header.columnOffsets[column] = offset;
+            offset += columnBytes(pointCount);
+        }
         
-        // Write each stroke
-        for (const auto& stroke : strokes) {
-            // Write color (3 floats)
-            glm::vec3 color = stroke->getColor();
-            file.write(reinterpret_cast<const char*>(&color.r), sizeof(float));
-            file.write(reinterpret_cast<const char*>(&color.g), sizeof(float));
-            file.write(reinterpret_cast<const char*>(&color.b), sizeof(float));
-            
-            // Write base width
-            float width = stroke->getBaseWidth();
-            file.write(reinterpret_cast<const char*>(&width), sizeof(float));
-            
-            // Write number of points
-            uint32_t numPoints = static_cast<uint32_t>(stroke->getPointCount());
-            file.write(reinterpret_cast<const char*>(&numPoints), sizeof(numPoints));
+        // Then the levels of detail, so loads copy them instead of rebuilding
+        const StrokePointArrays& lodPoints = strokes.getLevelOfDetailPoints();
+        const std::vector<uint32_t>& lodOffsets = strokes.getLevelOfDetailOffsets();
+        header.lodPointCount = lodPoints.size();
+        header.lodLevels = StrokePool::LOD_LEVELS;
+        header.lodOffsetsOffset = offset;
+        header.lodColumnsOffset = alignUp(offset + lodOffsets.size() * sizeof(uint32_t), COLUMN_ALIGNMENT);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        
+        // Write the stroke table
+        std::vector<StrokeRecordV2> table(strokes.size());
+        uint64_t firstPoint = 0;
+        for (size_t i = 0; i < strokes.size(); ++i) {
+            StrokeRecordV2& record = table[i];
+            glm::vec3 color = strokes.getColor(i);
+            BoundingBox bounds = strokes.getBounds(i);
             
-            // Write each point
-            const auto& points = stroke->getPoints();
-            for (const auto& point : points) {
-                file.write(reinterpret_cast<const char*>(&point.position.x), sizeof(float));
-                file.write(reinterpret_cast<const char*>(&point.position.y), sizeof(float));
-                file.write(reinterpret_cast<const char*>(&point.pressure), sizeof(float));
-                file.write(reinterpret_cast<const char*>(&point.tiltX), sizeof(float));
-                file.write(reinterpret_cast<const char*>(&point.tiltY), sizeof(float));
-                file.write(reinterpret_cast<const char*>(&point.timestamp), sizeof(float));
+            record.firstPoint = firstPoint;
+            record.pointCount = static_cast<uint32_t>(strokes.getPointCount(i));
+            record.baseWidth = strokes.getBaseWidth(i);
+            record.color[0] = color.r;
+            record.color[1] = color.g;
+            record.color[2] = color.b;
+            record.flags = (strokes.getEncoding(i) == StrokeEncoding::Cubic) ? STROKE_FLAG_CUBIC : 0;
+            record.bounds[0] = bounds.min.x;
+            record.bounds[1] = bounds.min.y;
+            record.bounds[2] = bounds.max.x;
+            record.bounds[3] = bounds.max.y;
+            firstPoint += record.pointCount;
+        }
+        file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(StrokeRecordV2));
+        
+        // The pool already stores each field contiguously, so every column is
+        // written straight from it (in chunks, to report progress)
+        const char padding[COLUMN_ALIGNMENT] = {};
+        auto pad = [&](uint64_t to) {
+            file.write(padding, static_cast<std::streamsize>(to - static_cast<uint64_t>(file.tellp())));
+        };
+        ProgressReporter reporter(progress, COLUMN_COUNT * (pointCount + header.lodPointCount));
+        uint64_t written = 0;
+        auto writeColumns = [&](const StrokePointArrays& source, uint64_t firstOffset) {
+            const std::vector<float>* columns[COLUMN_COUNT] = {
+                &source.x, &source.y, &source.pressure, &source.tiltX, &source.tiltY, &source.timestamp
+            };
+            const uint64_t total = source.size();
+            const uint64_t chunk = progress ? WRITE_CHUNK_POINTS : total;
+            for (int column = 0; column < COLUMN_COUNT; ++column) {
+                pad(firstOffset + column * columnBytes(total));
+                for (uint64_t first = 0; first < total; first += chunk) {
+                    const uint64_t count = std::min(chunk, total - first);
+                    file.write(reinterpret_cast<const char*>(columns[column]->data() + first), count * sizeof(float));
+                    written += count;
+                    reporter.update(written);
+                }
             }
+        };
+        writeColumns(points, header.columnOffsets[0]);
+        
+        pad(header.lodOffsetsOffset);
+        file.write(reinterpret_cast<const char*>(lodOffsets.data()), lodOffsets.size() * sizeof(uint32_t));
+        writeColumns(lodPoints, header.lodColumnsOffset);
+        
+        if (!file) {
+            VS_ERROR(File, "Failed to write file: " << filepath);
+            return false;
         }
         
         file.close();
-        std::cout << "Saved " << numStrokes << " strokes to " << filepath << std::endl;
+        VS_INFO(File, "Saved " << strokes.size() << " strokes to " << filepath);
         return true;
         
     } catch (const std::exception& e) {
-        std::cerr << "Error saving file: " << e.what() << std::endl;
+        VS_ERROR(File, "Error saving file: " << e.what());
         file.close();
         return false;
     }
 }
 
 bool Canvas::loadFromFile(const std::string& filepath) {
+    // Read into a fresh pool so a failed load leaves the canvas untouched
+    StrokePool loaded;
+    if (!readStrokes(filepath, loaded)) {
+        return false;
+    }
+    replaceStrokes(loaded);
+    return true;
+}
+
+bool Canvas::readStrokes(const std::string& filepath, StrokePool& loaded, const FileProgress& progress) {
     std::ifstream file(filepath, std::ios::binary);
     if (!file.is_open()) {
-        std::cerr << "Failed to open file for reading: " << filepath << std::endl;
+        VS_ERROR(File, "Failed to open file for reading: " << filepath);
         return false;
     }
     
@@ -211,142 +662,145 @@ bool Canvas::loadFromFile(const std::string& filepath) {
         // Read and verify header
         char magic[4];
         file.read(magic, 4);
-        if (magic[0] != 'M' || magic[1] != 'M' || magic[2] != 'V' || magic[3] != 'S') {
-            std::cerr << "Invalid file format (bad magic number)" << std::endl;
+        if (!file || std::memcmp(magic, SketchFormat::MAGIC, 4) != 0) {
+            VS_ERROR(File, "Invalid file format (bad magic number)");
             file.close();
             return false;
         }
         
         uint32_t version;
         file.read(reinterpret_cast<char*>(&version), sizeof(version));
-        if (version != 1) {
-            std::cerr << "Unsupported file version: " << version << std::endl;
+        
+        bool ok = false;
+        if (version == SketchFormat::VERSION_STREAMED) {
+            ok = readStreamedStrokes(file, loaded, progress);
+        } else if (version == SketchFormat::VERSION_MAPPED) {
             file.close();
-            return false;
+            MappedFile mapped;
+            ok = mapped.open(filepath) && readMappedStrokes(mapped.data(), mapped.size(), loaded, progress);
+        } else {
+            VS_ERROR(File, "Unsupported file version: " << version);
         }
-        
-        // Read number of strokes
-        uint32_t numStrokes;
-        file.read(reinterpret_cast<char*>(&numStrokes), sizeof(numStrokes));
-        
-        // Clear current strokes
-        strokes.clear();
-        
-        // Read each stroke
-        for (uint32_t i = 0; i < numStrokes; ++i) {
-            auto stroke = std::make_shared<Stroke>();
-            
-            // Read color
-            glm::vec3 color;
-            file.read(reinterpret_cast<char*>(&color.r), sizeof(float));
-            file.read(reinterpret_cast<char*>(&color.g), sizeof(float));
-            file.read(reinterpret_cast<char*>(&color.b), sizeof(float));
-            stroke->setColor(color);
-            
-            // Read base width
-            float width;
-            file.read(reinterpret_cast<char*>(&width), sizeof(float));
-            stroke->setBaseWidth(width);
-            
-            // Read number of points
-            uint32_t numPoints;
-            file.read(reinterpret_cast<char*>(&numPoints), sizeof(numPoints));
-            
-            // Read each point
-            for (uint32_t j = 0; j < numPoints; ++j) {
-                StrokePoint point;
-                file.read(reinterpret_cast<char*>(&point.position.x), sizeof(float));
-                file.read(reinterpret_cast<char*>(&point.position.y), sizeof(float));
-                file.read(reinterpret_cast<char*>(&point.pressure), sizeof(float));
-                file.read(reinterpret_cast<char*>(&point.tiltX), sizeof(float));
-                file.read(reinterpret_cast<char*>(&point.tiltY), sizeof(float));
-                file.read(reinterpret_cast<char*>(&point.timestamp), sizeof(float));
-                stroke->addPoint(point);
-            }
-            
-            strokes.push_back(stroke);
+        if (!ok) {
+            return false;
         }
         
-        file.close();
-        
-        // Initialize history after loading
-        history.clear();
-        std::vector<std::shared_ptr<Stroke>> initial;
-        for (const auto& stroke : strokes) {
-            auto strokeCopy = std::make_shared<Stroke>(*stroke);
-            initial.push_back(strokeCopy);
-        }
-        history.push_back(initial);
-        historyIndex = 0;
-        
-        std::cout << "Loaded " << numStrokes << " strokes from " << filepath << std::endl;
+        VS_INFO(File, "Loaded " << loaded.size() << " strokes from " << filepath);
         return true;
         
     } catch (const std::exception& e) {
-        std::cerr << "Error loading file: " << e.what() << std::endl;
-        file.close();
+        VS_ERROR(File, "Error loading file: " << e.what());
         return false;
     }
 }
 
-// Point-in-polygon test using ray casting algorithm
-bool Canvas::pointInPolygon(const glm::vec2& point, const std::vector<glm::vec2>& polygon) const {
-    if (polygon.size() < 3) return false;
-    
-    bool inside = false;
-    size_t j = polygon.size() - 1;
-    
-    for (size_t i = 0; i < polygon.size(); i++) {
-        if ((polygon[i].y > point.y) != (polygon[j].y > point.y) &&
-            (point.x < (polygon[j].x - polygon[i].x) * (point.y - polygon[i].y) / 
-                       (polygon[j].y - polygon[i].y) + polygon[i].x)) {
-            inside = !inside;
-        }
-        j = i;
-    }
-    
-    return inside;
+void Canvas::replaceStrokes(StrokePool& loaded) {
+    // Loading is undoable: the command keeps the previous canvas
+    Command command;
+    command.type = CommandType::Load;
+    command.strokes.swap(loaded);
+    currentStroke = nullptr;
+    applyCommand(command);
+    pushCommand(std::move(command));
 }
 
 void Canvas::selectStrokesInPolygon(const std::vector<glm::vec2>& lassoPoints) {
+    finishMovingSelection();
     selectedStrokes.clear();
+    dirty = true;
+    
+    BoundingBox lassoBounds;
+    for (const auto& point : lassoPoints) {
+        lassoBounds.expand(point);
+    }
     
-    std::cout << "Lasso selection: checking " << strokes.size() << " total strokes" << std::endl;
+    // Only strokes whose bounds overlap the lasso can have a point inside it
+    std::vector<size_t> candidates = queryStrokes(lassoBounds);
     
-    // Check each stroke
-    for (size_t i = 0; i < strokes.size(); ++i) {
-        const auto& stroke = strokes[i];
-        const auto& points = stroke->getPoints();
+    VS_DEBUG(Selection, "Lasso selection: checking " << candidates.size() << " of " << strokes.size() << " strokes");
+    
+    std::vector<glm::vec2> curve;
+    std::vector<float> curveX, curveY;
+    for (size_t i : candidates) {
+        // Fitted strokes are tested on their curves, not their control points
+        const float* x = strokes.getX(i);
+        const float* y = strokes.getY(i);
+        size_t count = strokes.getPointCount(i);
+        if (strokes.getEncoding(i) == StrokeEncoding::Cubic) {
+            centerlinePoints(strokes.view(i), curve);
+            curveX.resize(curve.size());
+            curveY.resize(curve.size());
+            for (size_t j = 0; j < curve.size(); ++j) {
+                curveX[j] = curve[j].x;
+                curveY[j] = curve[j].y;
+            }
+            x = curveX.data();
+            y = curveY.data();
+            count = curve.size();
+        }
         
         // If any point of the stroke is inside the lasso, select it
-        for (const auto& point : points) {
-            if (pointInPolygon(point.position, lassoPoints)) {
-                selectedStrokes.insert(i);
-                std::cout << "  → Stroke " << i << " selected (has " << points.size() << " points)" << std::endl;
-                break; // Found at least one point inside, select this stroke
-            }
+        if (StrokeKernels::anyPointInPolygon(x, y, count, lassoPoints)) {
+            selectedStrokes.insert(i);
+            VS_TRACE(Selection, "  → Stroke " << i << " selected (has " << strokes.getPointCount(i) << " points)");
         }
     }
     
-    std::cout << "✓ Selected " << selectedStrokes.size() << " out of " << strokes.size() << " stroke(s)" << std::endl;
+    VS_DEBUG(Selection, "✓ Selected " << selectedStrokes.size() << " out of " << strokes.size() << " stroke(s)");
 }
 
 void Canvas::clearSelection() {
-    selectedStrokes.clear();
+    finishMovingSelection();
+    if (!selectedStrokes.empty()) {
+        selectedStrokes.clear();
+        dirty = true;
+    }
 }
 
 void Canvas::moveSelectedStrokes(const glm::vec2& delta) {
     if (selectedStrokes.empty()) return;
     
-    std::cout << "Moving " << selectedStrokes.size() << " strokes by delta(" 
-              << delta.x << ", " << delta.y << ")" << std::endl;
+    VS_TRACE(Selection, "Moving " << selectedStrokes.size() << " strokes by delta("
+            << delta.x << ", " << delta.y << ")");
     
     // Move all points in selected strokes
     for (size_t idx : selectedStrokes) {
         if (idx < strokes.size()) {
-            strokes[idx]->movePoints(delta);
+            addDamage(strokes.getBounds(idx));
+            strokes.translate(idx, delta);
+            spatialIndex.update(idx, strokes.getBounds(idx));
+            addDamage(strokes.getBounds(idx));
         }
     }
+    
+    // A drag arrives as many small deltas; fold them into one undo step
+    std::vector<size_t> indices;
+    for (size_t idx : selectedStrokes) {
+        if (idx < strokes.size()) {
+            indices.push_back(idx);
+        }
+    }
+    if (indices.empty()) return;
+    if (historyIndex == history.size() && !history.empty()) {
+        Command& last = history.back();
+        if (last.type == CommandType::MoveSelection && last.open && last.indices == indices) {
+            last.delta += delta;
+            return;
+        }
+    }
+    
+    Command command;
+    command.type = CommandType::MoveSelection;
+    command.indices = std::move(indices);
+    command.delta = delta;
+    command.open = true;
+    pushCommand(std::move(command));
+}
+
+void Canvas::finishMovingSelection() {
+    if (historyIndex > 0) {
+        history[historyIndex - 1].open = false;
+    }
 }
 
 } // namespace VectorSketch
@@ -0,0 +1,36 @@
+// Canvas::render is kept apart from Canvas.cpp so the rest of Canvas builds
+// into vectorsketch_core without OpenGL
+#include "Canvas.h"
+#include "VectorRenderer.h"
+
+namespace VectorSketch {
+
+void Canvas::render(VectorRenderer& renderer) {
+    // Render completed strokes that overlap the view, in paint order. In
+    // composited mode this only happens when the strokes or the view changed
+    // (and after edits, only where they changed); other frames reuse the
+    // renderer's static layer
+    bool redraw = renderer.beginStaticLayer(strokes.getVersion(), fullDamage ? BoundingBox() : damage);
+    damage = BoundingBox();
+    fullDamage = false;
+    dirty = false;
+    if (redraw) {
+        // Cached tiles first; straight submission when they can't be used
+        bool tiled = renderer.isTileCaching() &&
+            renderer.renderTiles(strokes, [this](const BoundingBox& area) { return queryStrokes(area); });
+        if (!tiled) {
+            for (size_t index : queryStrokes(renderer.getRedrawBounds())) {
+                renderer.submitStroke(strokes, index);
+            }
+            renderer.flushBatch();
+        }
+    }
+    renderer.endStaticLayer();
+    
+    // Render current stroke being drawn
+    if (currentStroke && !currentStroke->isEmpty()) {
+        renderer.renderLiveStroke(*currentStroke);
+    }
+}
+
+} // namespace VectorSketch
@@ -0,0 +1,147 @@
+#include "Log.h"
+#include <atomic>
+#include <iostream>
+
+#ifdef VECTORSKETCH_LOG_ASYNC
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#endif
+
+namespace VectorSketch {
+namespace Log {
+
+namespace {
+
+std::atomic<int> runtimeLevel{VECTORSKETCH_LOG_LEVEL};
+
+void writeLine(Level level, const std::string& message) {
+    if (level >= Level::Warn) {
+        std::cerr << message << '\n';
+    } else {
+        std::cout << message << '\n';
+    }
+}
+
+#ifdef VECTORSKETCH_LOG_ASYNC
+// Producers only copy the message into a slot under the lock; the worker
+// thread does the actual console I/O
+class RingSink {
+public:
+    RingSink() : ring(CAPACITY), worker([this] { run(); }) {}
+
+    ~RingSink() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    void push(Level level, std::string message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == CAPACITY) {
+                ++dropped;
+                return;
+            }
+            ring[(head + count) % CAPACITY] = Entry{level, std::move(message)};
+            ++count;
+        }
+        wake.notify_one();
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return count == 0 && !writing; });
+    }
+
+private:
+    static constexpr size_t CAPACITY = 4096;
+
+    struct Entry {
+        Level level = Level::Info;
+        std::string message;
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return count > 0 || stopping; });
+            if (count == 0) {
+                break;  // Stopping and fully drained
+            }
+
+            Entry entry = std::move(ring[head]);
+            head = (head + 1) % CAPACITY;
+            --count;
+            size_t lost = std::exchange(dropped, 0);
+            writing = true;
+            lock.unlock();
+
+            if (lost > 0) {
+                writeLine(Level::Warn, "[log] " + std::to_string(lost) + " message(s) dropped, ring buffer full");
+            }
+            writeLine(entry.level, entry.message);
+
+            lock.lock();
+            writing = false;
+            if (count == 0) {
+                std::cout.flush();
+                drained.notify_all();
+            }
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable drained;
+    std::vector<Entry> ring;
+    size_t head = 0;
+    size_t count = 0;
+    size_t dropped = 0;
+    bool writing = false;
+    bool stopping = false;
+    std::thread worker;  // Last member: starts after everything above exists
+};
+
+RingSink& ringSink() {
+    static RingSink sink;
+    return sink;
+}
+#endif
+
+} // namespace
+
+void setLevel(Level level) {
+    runtimeLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+Level getLevel() {
+    return static_cast<Level>(runtimeLevel.load(std::memory_order_relaxed));
+}
+
+bool enabled(Level level) {
+    return static_cast<int>(level) >= runtimeLevel.load(std::memory_order_relaxed);
+}
+
+void write(Level level, Category category, const std::string& message) {
+    (void)category;  // Filtering happens at compile time in VS_LOG
+#ifdef VECTORSKETCH_LOG_ASYNC
+    ringSink().push(level, message);
+#else
+    writeLine(level, message);
+#endif
+}
+
+void flush() {
+#ifdef VECTORSKETCH_LOG_ASYNC
+    ringSink().flush();
+#endif
+}
+
+} // namespace Log
+} // namespace VectorSketch
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+#include "Log.h"
+#include <fstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define VECTORSKETCH_HAS_MMAP 1
+#endif
+
+namespace VectorSketch {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& filepath) {
+    close();
+    
+#ifdef VECTORSKETCH_HAS_MMAP
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        VS_ERROR(File, "Failed to open file for reading: " << filepath);
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        VS_ERROR(File, "Cannot map empty or unreadable file: " << filepath);
+        ::close(fd);
+        return false;
+    }
+    
+    void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference
+    if (address == MAP_FAILED) {
+        VS_ERROR(File, "Failed to map file: " << filepath);
+        return false;
+    }
+    
+    // The loader walks the columns front to back
+    madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    
+    bytes = static_cast<const uint8_t*>(address);
+    length = static_cast<size_t>(info.st_size);
+    mapped = true;
+    return true;
+#else
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        VS_ERROR(File, "Failed to open file for reading: " << filepath);
+        return false;
+    }
+    
+    std::streamsize fileSize = file.tellg();
+    if (fileSize <= 0) {
+        VS_ERROR(File, "Cannot load empty file: " << filepath);
+        return false;
+    }
+    
+    buffer.resize(static_cast<size_t>(fileSize));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(buffer.data()), fileSize)) {
+        VS_ERROR(File, "Failed to read file: " << filepath);
+        buffer.clear();
+        return false;
+    }
+    
+    bytes = buffer.data();
+    length = buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef VECTORSKETCH_HAS_MMAP
+    if (mapped && bytes) {
+        munmap(const_cast<uint8_t*>(bytes), length);
+    }
+#endif
+    buffer.clear();
+    buffer.shrink_to_fit();
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+} // namespace VectorSketch
@@ -0,0 +1,268 @@
+#include "SpatialIndex.h"
+#include <algorithm>
+
+namespace VectorSketch {
+
+void SpatialIndex::insert(size_t id, const BoundingBox& bounds) {
+    if (contains(id)) {
+        remove(id);
+    }
+    if (bounds.isEmpty() || !bounds.isFinite()) return;
+    
+    if (id >= itemNodes.size()) {
+        itemNodes.resize(id + 1, nullptr);
+        itemBounds.resize(id + 1);
+    }
+    itemBounds[id] = bounds;
+    
+    if (fitsTree(bounds)) {
+        growRootToFit(bounds);
+        insertIntoNode(root.get(), id);
+    } else {
+        insertIntoOverflow(id);
+    }
+    itemCount++;
+}
+
+void SpatialIndex::insertRange(size_t firstId, const BoundingBox* bounds, size_t count) {
+    BoundingBox all;
+    for (size_t i = 0; i < count; ++i) {
+        if (contains(firstId + i)) {
+            remove(firstId + i);
+        }
+        if (fitsTree(bounds[i])) {
+            all.expand(bounds[i]);
+        }
+    }
+    
+    if (firstId + count > itemNodes.size()) {
+        itemNodes.resize(firstId + count, nullptr);
+        itemBounds.resize(firstId + count);
+    }
+    if (!all.isEmpty()) {
+        growRootToFit(all);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (bounds[i].isEmpty() || !bounds[i].isFinite()) continue;
+        itemBounds[firstId + i] = bounds[i];
+        if (fitsTree(bounds[i])) {
+            insertIntoNode(root.get(), firstId + i);
+        } else {
+            insertIntoOverflow(firstId + i);
+        }
+        itemCount++;
+    }
+    
+    // Nothing indexed: drop the id tables' empty tail again
+    while (!itemNodes.empty() && itemNodes.back() == nullptr) {
+        itemNodes.pop_back();
+        itemBounds.pop_back();
+    }
+}
+
+void SpatialIndex::remove(size_t id) {
+    if (!contains(id)) return;
+    
+    auto& items = itemNodes[id]->items;
+    auto it = std::find(items.begin(), items.end(), id);
+    if (it != items.end()) {
+        *it = items.back();
+        items.pop_back();
+    }
+    itemNodes[id] = nullptr;
+    itemCount--;
+    
+    // Keep the id tables tight when the tail is removed (undo of the last stroke)
+    while (!itemNodes.empty() && itemNodes.back() == nullptr) {
+        itemNodes.pop_back();
+        itemBounds.pop_back();
+    }
+}
+
+void SpatialIndex::update(size_t id, const BoundingBox& bounds) {
+    if (contains(id)) {
+        Node* node = itemNodes[id];
+        // Still fits the same node and would not descend further: just store the box
+        if (node->bounds.contains(bounds) &&
+            (node->isLeaf() || childIndexFor(node, bounds) < 0)) {
+            itemBounds[id] = bounds;
+            return;
+        }
+    }
+    insert(id, bounds);
+}
+
+void SpatialIndex::clear() {
+    root.reset();
+    overflow.reset();
+    itemBounds.clear();
+    itemNodes.clear();
+    itemCount = 0;
+}
+
+bool SpatialIndex::fitsTree(const BoundingBox& bounds) {
+    // Also false for NaN corners
+    return !bounds.isEmpty() &&
+           BoundingBox(glm::vec2(-MAX_COORDINATE), glm::vec2(MAX_COORDINATE)).contains(bounds);
+}
+
+void SpatialIndex::insertIntoOverflow(size_t id) {
+    if (!overflow) {
+        overflow = std::make_unique<Node>();
+    }
+    overflow->items.push_back(id);
+    itemNodes[id] = overflow.get();
+}
+
+// Only called with boxes that fit the tree, so the root stops growing at a
+// few times MAX_COORDINATE across, far from float overflow
+void SpatialIndex::growRootToFit(const BoundingBox& bounds) {
+    if (!root) {
+        // Square power-of-two root centered on the first item
+        glm::vec2 size = bounds.max - bounds.min;
+        float extent = MIN_ROOT_SIZE;
+        while (extent < std::max(size.x, size.y)) extent *= 2.0f;
+        
+        glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+        root = std::make_unique<Node>();
+        root->bounds = BoundingBox(center - glm::vec2(extent), center + glm::vec2(extent));
+        return;
+    }
+    
+    // Double the root toward the new item until it fits; the old root
+    // becomes one quadrant of the new one
+    while (!root->bounds.contains(bounds)) {
+        const BoundingBox& old = root->bounds;
+        glm::vec2 size = old.max - old.min;
+        glm::vec2 itemCenter = (bounds.min + bounds.max) * 0.5f;
+        glm::vec2 oldCenter = (old.min + old.max) * 0.5f;
+        
+        bool growLeft = itemCenter.x < oldCenter.x;
+        bool growUp = itemCenter.y < oldCenter.y;
+        // Keep the old root's edges exact on its side: far from the origin,
+        // newMin + 2 * size rounds and would cut the old root off
+        glm::vec2 newMin(growLeft ? old.min.x - size.x : old.min.x,
+                         growUp ? old.min.y - size.y : old.min.y);
+        glm::vec2 newMax(growLeft ? old.max.x : old.max.x + size.x,
+                         growUp ? old.max.y : old.max.y + size.y);
+        
+        auto newRoot = std::make_unique<Node>();
+        newRoot->bounds = BoundingBox(newMin, newMax);
+        for (int q = 0; q < 4; ++q) {
+            newRoot->children[q] = std::make_unique<Node>();
+            newRoot->children[q]->bounds = childBounds(newRoot->bounds, q);
+        }
+        
+        int oldQuadrant = (growLeft ? 1 : 0) + (growUp ? 2 : 0);
+        newRoot->children[oldQuadrant] = std::move(root);
+        root = std::move(newRoot);
+        
+        // Depth is only used to cap splitting; shift the whole tree down one level
+        std::vector<Node*> stack{root.get()};
+        root->depth = -1;
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+            node->depth++;
+            if (!node->isLeaf()) {
+                for (auto& child : node->children) stack.push_back(child.get());
+            }
+        }
+    }
+}
+
+BoundingBox SpatialIndex::childBounds(const BoundingBox& parent, int quadrant) {
+    // Quadrants: 0 = top-left, 1 = top-right, 2 = bottom-left, 3 = bottom-right
+    glm::vec2 center = (parent.min + parent.max) * 0.5f;
+    glm::vec2 min((quadrant & 1) ? center.x : parent.min.x,
+                  (quadrant & 2) ? center.y : parent.min.y);
+    glm::vec2 max((quadrant & 1) ? parent.max.x : center.x,
+                  (quadrant & 2) ? parent.max.y : center.y);
+    return BoundingBox(min, max);
+}
+
+int SpatialIndex::childIndexFor(const Node* node, const BoundingBox& bounds) const {
+    glm::vec2 center = (node->bounds.min + node->bounds.max) * 0.5f;
+    
+    int quadrant = 0;
+    if (bounds.min.x >= center.x) quadrant |= 1;
+    else if (bounds.max.x > center.x) return -1;  // Straddles the vertical split
+    
+    if (bounds.min.y >= center.y) quadrant |= 2;
+    else if (bounds.max.y > center.y) return -1;  // Straddles the horizontal split
+    
+    return quadrant;
+}
+
+void SpatialIndex::insertIntoNode(Node* node, size_t id) {
+    const BoundingBox& bounds = itemBounds[id];
+    
+    while (!node->isLeaf()) {
+        int quadrant = childIndexFor(node, bounds);
+        // A grown root's old quadrant may be off its split by rounding
+        if (quadrant < 0 || !node->children[quadrant]->bounds.contains(bounds)) break;
+        node = node->children[quadrant].get();
+    }
+    
+    node->items.push_back(id);
+    itemNodes[id] = node;
+    
+    if (node->isLeaf() && node->items.size() > NODE_CAPACITY && node->depth < MAX_DEPTH) {
+        split(node);
+    }
+}
+
+void SpatialIndex::split(Node* node) {
+    for (int q = 0; q < 4; ++q) {
+        node->children[q] = std::make_unique<Node>();
+        node->children[q]->bounds = childBounds(node->bounds, q);
+        node->children[q]->depth = node->depth + 1;
+    }
+    
+    // Push down every item that fits entirely inside one quadrant
+    std::vector<size_t> items;
+    items.swap(node->items);
+    for (size_t id : items) {
+        int quadrant = childIndexFor(node, itemBounds[id]);
+        Node* target = (quadrant < 0) ? node : node->children[quadrant].get();
+        target->items.push_back(id);
+        itemNodes[id] = target;
+    }
+    
+    for (auto& child : node->children) {
+        if (child->items.size() > NODE_CAPACITY && child->depth < MAX_DEPTH) {
+            split(child.get());
+        }
+    }
+}
+
+void SpatialIndex::queryNode(const Node* node, const BoundingBox& area, std::vector<size_t>& results) const {
+    for (size_t id : node->items) {
+        if (itemBounds[id].intersects(area)) {
+            results.push_back(id);
+        }
+    }
+    
+    if (node->isLeaf()) return;
+    
+    for (const auto& child : node->children) {
+        if (child->bounds.intersects(area)) {
+            queryNode(child.get(), area, results);
+        }
+    }
+}
+
+void SpatialIndex::queryRect(const BoundingBox& area, std::vector<size_t>& results) const {
+    if (overflow) {
+        queryNode(overflow.get(), area, results);
+    }
+    if (!root || !root->bounds.intersects(area)) return;
+    queryNode(root.get(), area, results);
+}
+
+void SpatialIndex::queryPoint(const glm::vec2& point, std::vector<size_t>& results) const {
+    queryRect(BoundingBox(point, point), results);
+}
+
+} // namespace VectorSketch
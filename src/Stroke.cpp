@@ -1,19 +1,111 @@
 #include "Stroke.h"
+#include "StrokeKernels.h"
+#include <atomic>
+#include <cmath>
 
 namespace VectorSketch {
 
+namespace {
+// Revisions come from one global counter so a (id, revision) pair never
+// describes two different geometries, even after undo rewinds a stroke.
+std::atomic<uint64_t> nextStrokeId{1};
+std::atomic<uint64_t> nextRevision{1};
+}
+
+Stroke::Stroke()
+    : id(allocateId()), revision(allocateRevision()) {
+}
+
+uint64_t Stroke::allocateId() {
+    return nextStrokeId++;
+}
+
+uint64_t Stroke::allocateRevision() {
+    return nextRevision++;
+}
+
+void Stroke::touch() {
+    revision = allocateRevision();
+}
+
 void Stroke::addPoint(const StrokePoint& point) {
+    if (inputFilter.enabled && !points.empty()) {
+        const size_t last = points.size() - 1;
+        const glm::vec2 lastPosition(points.x[last], points.y[last]);
+        if (glm::distance(point.position, lastPosition) <= inputFilter.minDistance &&
+            std::abs(point.pressure - points.pressure[last]) <= inputFilter.pressureTolerance) {
+            return;
+        }
+        
+        if (points.size() >= 2 && filterDropped.size() < FILTER_MAX_DROPPED && canReplaceLast(point)) {
+            filterDropped.emplace_back(lastPosition, points.pressure[last]);
+            points.set(last, point);
+            pointBounds.expand(point.position);  // May stay a little loose around the dropped point
+            touch();
+            return;
+        }
+        filterDropped.clear();
+    }
+    
     points.push_back(point);
+    pointBounds.expand(point.position);
+    touch();
+}
+
+bool Stroke::canReplaceLast(const StrokePoint& point) const {
+    // Would the segment anchor -> point (the last point gone) still pass
+    // within tolerance of the last point and of everything dropped before it?
+    const size_t anchor = points.size() - 2;
+    const size_t last = anchor + 1;
+    const glm::vec2 a(points.x[anchor], points.y[anchor]);
+    const glm::vec2 ab = point.position - a;
+    const float ap = points.pressure[anchor];
+    const float abp = point.pressure - ap;
+    const float lengthSq = glm::dot(ab, ab);
+    
+    auto within = [&](const glm::vec2& position, float pressure) {
+        float t = (lengthSq > 0.0f) ? glm::clamp(glm::dot(position - a, ab) / lengthSq, 0.0f, 1.0f) : 0.0f;
+        return glm::distance(position, a + ab * t) <= inputFilter.tolerance &&
+               std::abs(pressure - (ap + abp * t)) <= inputFilter.pressureTolerance;
+    };
+    
+    if (!within(glm::vec2(points.x[last], points.y[last]), points.pressure[last])) {
+        return false;
+    }
+    for (const glm::vec3& dropped : filterDropped) {
+        if (!within(glm::vec2(dropped), dropped.z)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Stroke::setInputFilter(const StrokeInputFilter& filter) {
+    inputFilter = filter;
+    filterDropped.clear();
 }
 
 void Stroke::clear() {
+    filterDropped.clear();
     points.clear();
+    pointBounds = BoundingBox();
+    touch();
+}
+
+void Stroke::setColor(const glm::vec3& c) {
+    color = c;
+    touch();
+}
+
+void Stroke::setBaseWidth(float w) {
+    baseWidth = w;
+    touch();
 }
 
 void Stroke::movePoints(const glm::vec2& delta) {
-    for (auto& point : points) {
-        point.position += delta;
-    }
+    StrokeKernels::translate(points.x.data(), points.y.data(), points.size(), delta);
+    pointBounds.translate(delta);
+    touch();
 }
 
 } // namespace VectorSketch
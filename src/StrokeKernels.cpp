@@ -0,0 +1,221 @@
+#include "StrokeKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VS_RESTRICT __restrict__
+#elif defined(_MSC_VER)
+#define VS_RESTRICT __restrict
+#else
+#define VS_RESTRICT
+#endif
+
+namespace VectorSketch {
+
+void StrokeKernels::translate(float* VS_RESTRICT x, float* VS_RESTRICT y, size_t count, const glm::vec2& delta) {
+    const float dx = delta.x;
+    const float dy = delta.y;
+    for (size_t i = 0; i < count; ++i) {
+        x[i] += dx;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        y[i] += dy;
+    }
+}
+
+BoundingBox StrokeKernels::computeBounds(const float* VS_RESTRICT x, const float* VS_RESTRICT y, size_t count) {
+    BoundingBox bounds;
+    if (count == 0) return bounds;
+    
+    // A single running min/max is a reduction the compiler may not reorder
+    // without -ffast-math; LANES independent accumulators vectorize as is
+    constexpr size_t LANES = 8;
+    float minX[LANES], maxX[LANES], minY[LANES], maxY[LANES];
+    for (size_t k = 0; k < LANES; ++k) {
+        minX[k] = maxX[k] = x[0];
+        minY[k] = maxY[k] = y[0];
+    }
+    
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES) {
+        for (size_t k = 0; k < LANES; ++k) {
+            minX[k] = std::min(minX[k], x[i + k]);
+            maxX[k] = std::max(maxX[k], x[i + k]);
+            minY[k] = std::min(minY[k], y[i + k]);
+            maxY[k] = std::max(maxY[k], y[i + k]);
+        }
+    }
+    for (; i < count; ++i) {
+        minX[0] = std::min(minX[0], x[i]);
+        maxX[0] = std::max(maxX[0], x[i]);
+        minY[0] = std::min(minY[0], y[i]);
+        maxY[0] = std::max(maxY[0], y[i]);
+    }
+    
+    for (size_t k = 1; k < LANES; ++k) {
+        minX[0] = std::min(minX[0], minX[k]);
+        maxX[0] = std::max(maxX[0], maxX[k]);
+        minY[0] = std::min(minY[0], minY[k]);
+        maxY[0] = std::max(maxY[0], maxY[k]);
+    }
+    
+    bounds.min = glm::vec2(minX[0], minY[0]);
+    bounds.max = glm::vec2(maxX[0], maxY[0]);
+    return bounds;
+}
+
+bool StrokeKernels::allFinite(const float* VS_RESTRICT x, const float* VS_RESTRICT y, size_t count) {
+    // NaN fails the comparison too; no early exit, so the loop vectorizes
+    const float limit = std::numeric_limits<float>::max();
+    int finite = 1;
+    for (size_t i = 0; i < count; ++i) {
+        finite &= (std::abs(x[i]) <= limit) & (std::abs(y[i]) <= limit);
+    }
+    return finite != 0;
+}
+
+bool StrokeKernels::anyPointInPolygon(const float* VS_RESTRICT x, const float* VS_RESTRICT y, size_t count,
+                                      const std::vector<glm::vec2>& polygon) {
+    if (polygon.size() < 3 || count == 0) return false;
+    
+    BoundingBox polygonBounds;
+    for (const auto& vertex : polygon) {
+        polygonBounds.expand(vertex);
+    }
+    const float minX = polygonBounds.min.x, maxX = polygonBounds.max.x;
+    const float minY = polygonBounds.min.y, maxY = polygonBounds.max.y;
+    
+    // 32-bit flags match the width of the float compares, so no packing is needed
+    int32_t inside[POLYGON_BLOCK];
+    
+    for (size_t start = 0; start < count; start += POLYGON_BLOCK) {
+        const size_t n = std::min(POLYGON_BLOCK, count - start);
+        const float* VS_RESTRICT bx = x + start;
+        const float* VS_RESTRICT by = y + start;
+        
+        // Cheap box test first; most blocks of a large selection miss the lasso
+        int32_t anyInBounds = 0;
+        for (size_t i = 0; i < n; ++i) {
+            anyInBounds |= (bx[i] >= minX) & (bx[i] <= maxX) & (by[i] >= minY) & (by[i] <= maxY);
+        }
+        if (!anyInBounds) continue;
+        
+        std::fill(inside, inside + n, 0);
+        
+        // Edge-major ray casting: each edge flips the parity of every point
+        // whose rightward ray crosses it
+        size_t j = polygon.size() - 1;
+        for (size_t e = 0; e < polygon.size(); ++e) {
+            const float xi = polygon[e].x, yi = polygon[e].y;
+            const float xj = polygon[j].x, yj = polygon[j].y;
+            const float slope = (xj - xi) / (yj - yi);  // inf for horizontal edges; masked below
+            for (size_t i = 0; i < n; ++i) {
+                const bool straddles = (yi > by[i]) != (yj > by[i]);
+                const bool left = bx[i] < slope * (by[i] - yi) + xi;
+                inside[i] ^= static_cast<int32_t>(straddles & left);
+            }
+            j = e;
+        }
+        
+        int32_t any = 0;
+        for (size_t i = 0; i < n; ++i) {
+            any |= inside[i];
+        }
+        if (any) return true;
+    }
+    return false;
+}
+
+void StrokeKernels::catmullRomControlPoints(const float* VS_RESTRICT x, const float* VS_RESTRICT y, size_t count,
+                                            float tension,
+                                            float* VS_RESTRICT c1x, float* VS_RESTRICT c1y,
+                                            float* VS_RESTRICT c2x, float* VS_RESTRICT c2y) {
+    if (count < 2) return;
+    const size_t segments = count - 1;
+    
+    // Same arithmetic as BezierSmoother's per-segment code, so results match bit for bit:
+    // c1 = p[i] + (p[i+1] - p[i-1]) * tension / 3, c2 = p[i+1] - (p[i+2] - p[i]) * tension / 3
+    auto edge = [&](size_t i) {
+        const size_t prev = (i > 0) ? i - 1 : i;
+        const size_t next = (i + 2 < count) ? i + 2 : i + 1;
+        c1x[i] = x[i] + ((x[i + 1] - x[prev]) * tension) / 3.0f;
+        c1y[i] = y[i] + ((y[i + 1] - y[prev]) * tension) / 3.0f;
+        c2x[i] = x[i + 1] - ((x[next] - x[i]) * tension) / 3.0f;
+        c2y[i] = y[i + 1] - ((y[next] - y[i]) * tension) / 3.0f;
+    };
+    
+    edge(0);
+    if (segments == 1) return;
+    
+    // Interior segments have both neighbours, so the loop has no branches
+    for (size_t i = 1; i + 1 < segments; ++i) {
+        c1x[i] = x[i] + ((x[i + 1] - x[i - 1]) * tension) / 3.0f;
+        c2x[i] = x[i + 1] - ((x[i + 2] - x[i]) * tension) / 3.0f;
+    }
+    for (size_t i = 1; i + 1 < segments; ++i) {
+        c1y[i] = y[i] + ((y[i + 1] - y[i - 1]) * tension) / 3.0f;
+        c2y[i] = y[i + 1] - ((y[i + 2] - y[i]) * tension) / 3.0f;
+    }
+    
+    edge(segments - 1);
+}
+
+void StrokeKernels::simplificationErrors(const float* VS_RESTRICT x, const float* VS_RESTRICT y,
+                                         const float* VS_RESTRICT pressure, size_t count,
+                                         float halfWidthScale, float minTolerance, float* VS_RESTRICT errors) {
+    if (count == 0) return;
+    
+    std::fill(errors, errors + count, 0.0f);
+    errors[0] = errors[count - 1] = std::numeric_limits<float>::infinity();
+    
+    // Spans (first, last) still to split, with the error of the split that
+    // created them: a point can't outlive the span it was found in
+    thread_local std::vector<std::pair<uint32_t, uint32_t>> spans;
+    thread_local std::vector<float> spanErrors;
+    spans.clear();
+    spanErrors.clear();
+    spans.emplace_back(0u, static_cast<uint32_t>(count - 1));
+    spanErrors.push_back(std::numeric_limits<float>::infinity());
+    const float minToleranceSq = minTolerance * minTolerance;
+    
+    while (!spans.empty()) {
+        const size_t first = spans.back().first;
+        const size_t last = spans.back().second;
+        const float parentError = spanErrors.back();
+        spans.pop_back();
+        spanErrors.pop_back();
+        
+        const float ax = x[first], ay = y[first], ap = pressure[first];
+        const float abx = x[last] - ax, aby = y[last] - ay, abp = pressure[last] - ap;
+        const float lengthSq = abx * abx + aby * aby;
+        const float inverseLengthSq = (lengthSq > 0.0f) ? 1.0f / lengthSq : 0.0f;
+        
+        // Squared errors only; the farthest point decides the split
+        float worst = -1.0f;
+        size_t worstIndex = first;
+        for (size_t i = first + 1; i < last; ++i) {
+            const float px = x[i] - ax, py = y[i] - ay;
+            const float t = std::clamp((px * abx + py * aby) * inverseLengthSq, 0.0f, 1.0f);
+            const float dx = px - abx * t, dy = py - aby * t;
+            const float dw = (pressure[i] - (ap + abp * t)) * halfWidthScale;
+            const float error = std::max(dx * dx + dy * dy, dw * dw);
+            worstIndex = (error > worst) ? i : worstIndex;
+            worst = std::max(error, worst);
+        }
+        
+        // Below minTolerance nothing is kept, so the span needs no more splits
+        if (worst > minToleranceSq) {
+            const float error = std::min(std::sqrt(worst), parentError);
+            errors[worstIndex] = error;
+            spans.emplace_back(static_cast<uint32_t>(first), static_cast<uint32_t>(worstIndex));
+            spans.emplace_back(static_cast<uint32_t>(worstIndex), static_cast<uint32_t>(last));
+            spanErrors.push_back(error);
+            spanErrors.push_back(error);
+        }
+    }
+}
+
+} // namespace VectorSketch
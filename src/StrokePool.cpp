@@ -0,0 +1,320 @@
+#include "StrokePool.h"
+#include "StrokeKernels.h"
+#include <algorithm>
+#include <utility>
+
+namespace VectorSketch {
+
+namespace {
+// Copy `count` points given as separate columns to the end of target
+void appendPoints(StrokePointArrays& target, const StrokeView::Columns& columns, size_t count) {
+    target.x.insert(target.x.end(), columns.x, columns.x + count);
+    target.y.insert(target.y.end(), columns.y, columns.y + count);
+    target.pressure.insert(target.pressure.end(), columns.pressure, columns.pressure + count);
+    target.tiltX.insert(target.tiltX.end(), columns.tiltX, columns.tiltX + count);
+    target.tiltY.insert(target.tiltY.end(), columns.tiltY, columns.tiltY + count);
+    target.timestamp.insert(target.timestamp.end(), columns.timestamp, columns.timestamp + count);
+}
+} // namespace
+
+void StrokePool::reserve(size_t strokeCount, size_t pointCount) {
+    Storage& pool = storage.write();
+    pool.points.reserve(pointCount);
+    pool.offsets.reserve(strokeCount + 1);
+    pool.ids.reserve(strokeCount);
+    pool.revisions.reserve(strokeCount);
+    pool.colors.reserve(strokeCount);
+    pool.widths.reserve(strokeCount);
+    pool.bounds.reserve(strokeCount);
+    pool.encodings.reserve(strokeCount);
+    pool.lodOffsets.reserve(strokeCount * LOD_LEVELS + 1);
+}
+
+void StrokePool::clear() {
+    // Drops this pool's share of the arrays; copies keep theirs
+    storage = CopyOnWrite<Storage>();
+    version = Stroke::allocateRevision();
+}
+
+void StrokePool::swap(StrokePool& other) {
+    storage.swap(other.storage);
+    std::swap(version, other.version);
+}
+
+StrokeView StrokePool::view(size_t i) const {
+    const Storage& pool = *storage;
+    const size_t first = pool.offsets[i];
+    StrokeView::Columns columns{pool.points.x.data() + first, pool.points.y.data() + first,
+                                pool.points.pressure.data() + first, pool.points.tiltX.data() + first,
+                                pool.points.tiltY.data() + first, pool.points.timestamp.data() + first};
+    return StrokeView(columns, getPointCount(i), pool.colors[i], pool.widths[i], pool.bounds[i], pool.ids[i],
+                      pool.revisions[i], pool.encodings[i]);
+}
+
+StrokeView StrokePool::lodView(size_t i, int level) const {
+    const Storage& pool = *storage;
+    const size_t first = pool.lodOffsets[i * LOD_LEVELS + level];
+    const size_t count = pool.lodOffsets[i * LOD_LEVELS + level + 1] - first;
+    StrokeView::Columns columns{pool.lodPoints.x.data() + first, pool.lodPoints.y.data() + first,
+                                pool.lodPoints.pressure.data() + first, pool.lodPoints.tiltX.data() + first,
+                                pool.lodPoints.tiltY.data() + first, pool.lodPoints.timestamp.data() + first};
+    return StrokeView(columns, count, pool.colors[i], pool.widths[i], pool.bounds[i], pool.ids[i],
+                      pool.revisions[i], StrokeEncoding::Samples, level);
+}
+
+StrokeView StrokePool::simplifiedView(size_t i, float maxError) const {
+    const Storage& pool = *storage;
+    
+    // Everything within maxError of the first point: a dot is close enough
+    const glm::vec2 extent = pool.bounds[i].max - pool.bounds[i].min;
+    if (getPointCount(i) > 1 && extent.x * extent.x + extent.y * extent.y <= maxError * maxError) {
+        StrokeView full = view(i);
+        return StrokeView(full.getColumns(), 1, pool.colors[i], pool.widths[i], pool.bounds[i], pool.ids[i],
+                          pool.revisions[i], StrokeEncoding::Samples, LOD_DOT);
+    }
+    
+    for (int level = LOD_LEVELS - 1; level >= 0; --level) {
+        const size_t slot = i * LOD_LEVELS + level;
+        if (LOD_TOLERANCES[level] <= maxError && pool.lodOffsets[slot + 1] > pool.lodOffsets[slot]) {
+            return lodView(i, level);
+        }
+    }
+    return view(i);
+}
+
+void StrokePool::buildLevelsOfDetail(Storage& pool, size_t i) {
+    // Scratch reused across strokes; loads append many strokes in a row
+    thread_local std::vector<float> errors;
+    
+    const size_t first = pool.offsets[i];
+    const size_t count = pool.offsets[i + 1] - first;
+    if (count < LOD_MIN_POINTS || pool.encodings[i] != StrokeEncoding::Samples) {
+        pool.lodOffsets.insert(pool.lodOffsets.end(), LOD_LEVELS, static_cast<uint32_t>(pool.lodPoints.size()));
+        return;
+    }
+    errors.resize(count);
+    StrokeKernels::simplificationErrors(pool.points.x.data() + first, pool.points.y.data() + first,
+                                        pool.points.pressure.data() + first, count,
+                                        pool.widths[i] * 0.5f, LOD_TOLERANCES[0], errors.data());
+    
+    size_t finerCount = count;
+    for (int level = 0; level < LOD_LEVELS; ++level) {
+        const float tolerance = LOD_TOLERANCES[level];
+        const size_t kept = static_cast<size_t>(std::count_if(errors.begin(), errors.end(),
+                                                              [tolerance](float e) { return e > tolerance; }));
+        if (kept * 4 <= finerCount * 3) {
+            for (size_t p = 0; p < count; ++p) {
+                if (errors[p] > tolerance) pool.lodPoints.push_back(pool.points.get(first + p));
+            }
+            finerCount = kept;
+        }
+        pool.lodOffsets.push_back(static_cast<uint32_t>(pool.lodPoints.size()));
+    }
+}
+
+size_t StrokePool::append(const StrokeView& stroke) {
+    Storage& pool = storage.write();
+    appendPoints(pool.points, stroke.getColumns(), stroke.getPointCount());
+    pool.offsets.push_back(static_cast<uint32_t>(pool.points.size()));
+    pool.ids.push_back(stroke.getId());
+    pool.revisions.push_back(stroke.getRevision());
+    pool.colors.push_back(stroke.getColor());
+    pool.widths.push_back(stroke.getBaseWidth());
+    pool.bounds.push_back(stroke.getBounds());
+    pool.encodings.push_back(stroke.getEncoding());
+    buildLevelsOfDetail(pool, pool.ids.size() - 1);
+    version = Stroke::allocateRevision();
+    return pool.ids.size() - 1;
+}
+
+size_t StrokePool::append(const StrokePoint* strokePoints, size_t count, const glm::vec3& color, float baseWidth,
+                          StrokeEncoding encoding) {
+    Storage& pool = storage.write();
+    const size_t first = pool.points.size();
+    for (size_t i = 0; i < count; ++i) {
+        pool.points.push_back(strokePoints[i]);
+    }
+    pool.offsets.push_back(static_cast<uint32_t>(pool.points.size()));
+    
+    BoundingBox pointBounds = StrokeKernels::computeBounds(pool.points.x.data() + first, pool.points.y.data() + first,
+                                                           count);
+    pool.ids.push_back(Stroke::allocateId());
+    pool.revisions.push_back(Stroke::allocateRevision());
+    pool.colors.push_back(color);
+    pool.widths.push_back(baseWidth);
+    pool.bounds.push_back(pointBounds.inflated(baseWidth * 0.5f));
+    pool.encodings.push_back(encoding);
+    buildLevelsOfDetail(pool, pool.ids.size() - 1);
+    version = Stroke::allocateRevision();
+    return pool.ids.size() - 1;
+}
+
+size_t StrokePool::appendFrom(const StrokePool& other, size_t i) {
+    return appendRange(other, i, i + 1);
+}
+
+size_t StrokePool::appendRange(const StrokePool& other, size_t first, size_t last) {
+    const size_t firstStroke = size();
+    if (first >= last) return firstStroke;
+    
+    Storage& pool = storage.write();
+    const Storage& source = *other.storage;
+    // Both pools store strokes back to back, so a range is one run of points
+    // (and of level-of-detail points) with its offsets shifted
+    const size_t pointFirst = source.offsets[first];
+    const size_t pointBase = pool.points.size();
+    pool.points.append(source.points, pointFirst, source.offsets[last]);
+    for (size_t i = first + 1; i <= last; ++i) {
+        pool.offsets.push_back(static_cast<uint32_t>(pointBase + source.offsets[i] - pointFirst));
+    }
+    
+    const size_t lodFirst = source.lodOffsets[first * LOD_LEVELS];
+    const size_t lodBase = pool.lodPoints.size();
+    pool.lodPoints.append(source.lodPoints, lodFirst, source.lodOffsets[last * LOD_LEVELS]);
+    for (size_t k = first * LOD_LEVELS + 1; k <= last * LOD_LEVELS; ++k) {
+        pool.lodOffsets.push_back(static_cast<uint32_t>(lodBase + source.lodOffsets[k] - lodFirst));
+    }
+    
+    pool.ids.insert(pool.ids.end(), source.ids.begin() + first, source.ids.begin() + last);
+    pool.revisions.insert(pool.revisions.end(), source.revisions.begin() + first, source.revisions.begin() + last);
+    pool.colors.insert(pool.colors.end(), source.colors.begin() + first, source.colors.begin() + last);
+    pool.widths.insert(pool.widths.end(), source.widths.begin() + first, source.widths.begin() + last);
+    pool.bounds.insert(pool.bounds.end(), source.bounds.begin() + first, source.bounds.begin() + last);
+    pool.encodings.insert(pool.encodings.end(), source.encodings.begin() + first, source.encodings.begin() + last);
+    version = Stroke::allocateRevision();
+    return firstStroke;
+}
+
+size_t StrokePool::appendPacked(const float* packedPoints, size_t stride, const uint32_t* pointOffsets,
+                                size_t strokeCount, const float* packedColors, const float* baseWidths) {
+    Storage& pool = storage.write();
+    const size_t firstStroke = pool.ids.size();
+    const size_t pointBase = pool.points.size();
+    const size_t pointCount = pointOffsets[strokeCount] - pointOffsets[0];
+    const float* source = packedPoints + static_cast<size_t>(pointOffsets[0]) * stride;
+    
+    // De-interleave field by field, so each pass writes one column (resize
+    // grows the capacity geometrically, so repeated imports stay linear)
+    const StrokePoint defaults;
+    const float fieldDefaults[] = {
+        defaults.position.x, defaults.position.y, defaults.pressure, defaults.tiltX, defaults.tiltY, defaults.timestamp
+    };
+    std::vector<float>* columns[] = {
+        &pool.points.x, &pool.points.y, &pool.points.pressure,
+        &pool.points.tiltX, &pool.points.tiltY, &pool.points.timestamp
+    };
+    for (size_t field = 0; field < 6; ++field) {
+        std::vector<float>& column = *columns[field];
+        if (field < stride) {
+            column.resize(pointBase + pointCount);
+            float* out = column.data() + pointBase;
+            for (size_t p = 0; p < pointCount; ++p) {
+                out[p] = source[p * stride + field];
+            }
+        } else {
+            column.resize(pointBase + pointCount, fieldDefaults[field]);
+        }
+    }
+    
+    for (size_t s = 0; s < strokeCount; ++s) {
+        const size_t first = pointBase + pointOffsets[s] - pointOffsets[0];
+        const size_t count = pointOffsets[s + 1] - pointOffsets[s];
+        pool.offsets.push_back(static_cast<uint32_t>(first + count));
+        
+        BoundingBox pointBounds = StrokeKernels::computeBounds(pool.points.x.data() + first,
+                                                               pool.points.y.data() + first, count);
+        pool.ids.push_back(Stroke::allocateId());
+        pool.revisions.push_back(Stroke::allocateRevision());
+        pool.colors.emplace_back(packedColors[s * 3], packedColors[s * 3 + 1], packedColors[s * 3 + 2]);
+        pool.widths.push_back(baseWidths[s]);
+        pool.bounds.push_back(pointBounds.inflated(baseWidths[s] * 0.5f));
+        pool.encodings.push_back(StrokeEncoding::Samples);
+        buildLevelsOfDetail(pool, pool.ids.size() - 1);
+    }
+    version = Stroke::allocateRevision();
+    return firstStroke;
+}
+
+size_t StrokePool::appendColumns(const StrokeView::Columns& columns, const uint32_t* pointOffsets,
+                                 size_t strokeCount, const glm::vec3* strokeColors, const float* baseWidths,
+                                 const BoundingBox* strokeBounds, const StrokeEncoding* strokeEncodings,
+                                 const LevelOfDetailColumns* levels) {
+    Storage& pool = storage.write();
+    const size_t firstStroke = pool.ids.size();
+    const size_t pointBase = pool.points.size();
+    const size_t pointCount = pointOffsets[strokeCount];
+    
+    appendPoints(pool.points, columns, pointCount);
+    for (size_t s = 1; s <= strokeCount; ++s) {
+        pool.offsets.push_back(static_cast<uint32_t>(pointBase + pointOffsets[s]));
+    }
+    if (levels) {
+        const size_t lodBase = pool.lodPoints.size();
+        appendPoints(pool.lodPoints, levels->columns, levels->offsets[strokeCount * LOD_LEVELS]);
+        for (size_t k = 1; k <= strokeCount * LOD_LEVELS; ++k) {
+            pool.lodOffsets.push_back(static_cast<uint32_t>(lodBase + levels->offsets[k]));
+        }
+    }
+    
+    pool.colors.insert(pool.colors.end(), strokeColors, strokeColors + strokeCount);
+    pool.widths.insert(pool.widths.end(), baseWidths, baseWidths + strokeCount);
+    pool.bounds.insert(pool.bounds.end(), strokeBounds, strokeBounds + strokeCount);
+    pool.encodings.insert(pool.encodings.end(), strokeEncodings, strokeEncodings + strokeCount);
+    for (size_t s = 0; s < strokeCount; ++s) {
+        pool.ids.push_back(Stroke::allocateId());
+        pool.revisions.push_back(Stroke::allocateRevision());
+        if (!levels) buildLevelsOfDetail(pool, firstStroke + s);
+    }
+    version = Stroke::allocateRevision();
+    return firstStroke;
+}
+
+void StrokePool::popBack() {
+    if (empty()) return;
+    truncate(size() - 1);
+}
+
+void StrokePool::truncate(size_t count) {
+    if (count >= size()) return;
+    
+    Storage& pool = storage.write();
+    pool.offsets.resize(count + 1);
+    pool.points.resize(pool.offsets.back());
+    pool.ids.resize(count);
+    pool.revisions.resize(count);
+    pool.colors.resize(count);
+    pool.widths.resize(count);
+    pool.bounds.resize(count);
+    pool.encodings.resize(count);
+    pool.lodOffsets.resize(count * LOD_LEVELS + 1);
+    pool.lodPoints.resize(pool.lodOffsets.back());
+    version = Stroke::allocateRevision();
+}
+
+void StrokePool::translate(size_t i, const glm::vec2& delta) {
+    Storage& pool = storage.write();
+    const size_t first = pool.offsets[i];
+    StrokeKernels::translate(pool.points.x.data() + first, pool.points.y.data() + first, getPointCount(i), delta);
+    const size_t lodFirst = pool.lodOffsets[i * LOD_LEVELS];
+    StrokeKernels::translate(pool.lodPoints.x.data() + lodFirst, pool.lodPoints.y.data() + lodFirst,
+                             pool.lodOffsets[(i + 1) * LOD_LEVELS] - lodFirst, delta);
+    pool.bounds[i].translate(delta);
+    pool.revisions[i] = Stroke::allocateRevision();
+    version = pool.revisions[i];
+}
+
+size_t StrokePool::getMemoryUsage() const {
+    const Storage& pool = *storage;
+    return pool.points.capacity() * sizeof(StrokePoint) +  // Six float columns, same bytes per point
+           pool.offsets.capacity() * sizeof(uint32_t) +
+           pool.ids.capacity() * sizeof(uint64_t) +
+           pool.revisions.capacity() * sizeof(uint64_t) +
+           pool.colors.capacity() * sizeof(glm::vec3) +
+           pool.widths.capacity() * sizeof(float) +
+           pool.bounds.capacity() * sizeof(BoundingBox) +
+           pool.encodings.capacity() * sizeof(StrokeEncoding) +
+           pool.lodPoints.capacity() * sizeof(StrokePoint) +
+           pool.lodOffsets.capacity() * sizeof(uint32_t);
+}
+
+} // namespace VectorSketch
@@ -11,6 +11,22 @@ ToolWheel::ToolWheel()
       currentColor(0.0f, 0.0f, 0.0f),  // Black by default
       mouseOverUI(false),
       wheelVisible(true) {
+    // Sub-pixel deviations are invisible; the eraser paints white over
+    // strokes and can follow the cursor more loosely
+    StrokeInputFilter brush;
+    brush.enabled = true;
+    brush.minDistance = 0.5f;
+    brush.tolerance = 0.35f;
+    brush.pressureTolerance = 0.03f;
+    brush.fitTolerance = 1.0f;
+    inputFilters[static_cast<int>(ToolType::BRUSH)] = brush;
+    
+    StrokeInputFilter eraser = brush;
+    eraser.minDistance = 1.0f;
+    eraser.tolerance = 1.0f;
+    eraser.pressureTolerance = 0.1f;
+    eraser.fitTolerance = 2.0f;
+    inputFilters[static_cast<int>(ToolType::ERASER)] = eraser;
 }
 
 void ToolWheel::render(int windowWidth, int windowHeight) {
@@ -1,6 +1,9 @@
 #include "VectorRenderer.h"
-#include <iostream>
+#include "Log.h"
 #include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cmath>
 
 namespace VectorSketch {
 
@@ -26,6 +29,296 @@ void main() {
 }
 )";
 
+// Batched mode: color travels with each vertex so many strokes share a draw call
+static const char* batchVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec4 aColor;
+
+uniform mat4 uMVP;
+
+out vec4 vColor;
+
+void main() {
+    vColor = aColor;
+    gl_Position = uMVP * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+static const char* batchFragmentShaderSource = R"(
+#version 330 core
+in vec4 vColor;
+out vec4 FragColor;
+
+void main() {
+    FragColor = vColor;
+}
+)";
+
+// GpuExpanded mode: each instance is one Bézier segment (attributes from one
+// record, end point and end width from the next). Vertices come from
+// gl_VertexID as one strip: left/right pairs along the curve, then a round
+// cap around p0 on the first segment and on the closing record of a
+// stroke. Instances all emit the same number of vertices; the ones the
+// error tolerance doesn't need, and the cap of inner segments, collapse
+// onto a single point so their triangles have no area.
+// With analytic antialiasing (uFringe > 0) outlines move out by one pixel
+// and vEdge carries, in pixels, each vertex's offset from the centerline,
+// the half width there and how far a cap vertex reaches into the body.
+static const char* segmentVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aP0;
+layout (location = 1) in vec2 aC1;
+layout (location = 2) in vec2 aC2;
+layout (location = 3) in float aWidth;
+layout (location = 4) in vec4 aColor;  // a: 1 first segment, 0.5 inner, 0 closing record
+layout (location = 5) in vec2 aP1;
+layout (location = 6) in float aWidthEnd;
+
+uniform mat4 uMVP;
+uniform int uSamples;          // Centerline samples emitted per segment
+uniform int uCapSegments;      // Cap segments emitted per segment
+uniform float uPixelsPerUnit;  // 0 = fixed tessellation, use all of them
+uniform float uTolerance;      // Pixels, adaptive tessellation
+uniform float uFringe;         // World size of a pixel; 0 = no antialiasing fringe
+
+out vec3 vColor;
+out vec4 vEdge;  // xy: offset from the centerline, z: half width, w: > 0 inside the body
+
+const float PI = 3.14159265;
+const vec4 COLLAPSED = vec4(2.0, 2.0, 2.0, 1.0);
+
+vec2 bezier(float t) {
+    float u = 1.0 - t;
+    return u * u * u * aP0 + 3.0 * u * u * t * aC1 + 3.0 * u * t * t * aC2 + t * t * t * aP1;
+}
+
+vec2 bezierTangent(float t) {
+    float u = 1.0 - t;
+    vec2 tangent = 3.0 * u * u * (aC1 - aP0) + 6.0 * u * t * (aC2 - aC1) + 3.0 * t * t * (aP1 - aC2);
+    return (dot(tangent, tangent) < 1e-12) ? aP1 - aP0 : tangent;  // Zero-length handle
+}
+
+// Left (side -1) or right (side 1) outline point at centerline sample i
+vec4 outline(int i, int samples, float side) {
+    float t = float(i) / float(samples - 1);
+    vec2 tangent = bezierTangent(t);
+    vec2 normal = (dot(tangent, tangent) > 1e-12) ? normalize(vec2(-tangent.y, tangent.x)) : vec2(0.0);
+    float halfWidth = mix(aWidth, aWidthEnd, t) * 0.5;
+    float reach = halfWidth + uFringe;
+    vEdge = vec4(side * reach, 0.0, halfWidth, -1.0) / max(uFringe, 1e-30);
+    return uMVP * vec4(bezier(t) + normal * side * reach, 0.0, 1.0);
+}
+
+void main() {
+    vColor = aColor.rgb;
+    vEdge = vec4(0.0);
+    bool closing = aColor.a < 0.25;
+    float halfWidth = aWidth * 0.5;
+    
+    // Where the body lies seen from the cap; the closing record keeps a
+    // point before the stroke's end in c1, dots have none
+    vec2 bodyDirection = closing ? aC1 - aP0 : bezierTangent(0.0);
+    bool hasBody = dot(bodyDirection, bodyDirection) > 1e-12;
+    bool capped = (closing && hasBody) || aColor.a > 0.75;
+    
+    // Same bounds as BezierSmoother::segmentSampleCount / circleSegmentCount
+    int samples = closing ? 0 : uSamples;
+    int capSegments = uCapSegments;
+    if (uPixelsPerUnit > 0.0) {
+        if (!closing) {
+            float m = max(length(aP0 - 2.0 * aC1 + aC2), length(aC1 - 2.0 * aC2 + aP1)) * uPixelsPerUnit;
+            float steps = sqrt(0.75 * m / uTolerance);
+            vec2 startTangent = aC1 - aP0;
+            vec2 endTangent = aP1 - aC2;
+            if (length(startTangent) > 0.0001 && length(endTangent) > 0.0001) {
+                float turn = acos(clamp(dot(normalize(startTangent), normalize(endTangent)), -1.0, 1.0));
+                steps = max(steps, turn * sqrt(halfWidth * uPixelsPerUnit / (8.0 * uTolerance)));
+            }
+            samples = clamp(int(ceil(steps)) + 1, 2, uSamples);
+        }
+        float radius = halfWidth * uPixelsPerUnit;
+        capSegments = (radius <= uTolerance) ? 6
+            : clamp(int(ceil(PI / acos(1.0 - uTolerance / radius))), 6, uCapSegments);
+    }
+    
+    int v = gl_VertexID;
+    int bodyVertices = 2 * uSamples;
+    if (v < bodyVertices) {
+        // The first unused vertex repeats the last pair's right point, so
+        // the triangle closing the body is degenerate
+        int i = v / 2;
+        if (i < samples) {
+            gl_Position = outline(i, samples, ((v & 1) == 0) ? -1.0 : 1.0);
+        } else if (v == 2 * samples && samples > 0) {
+            gl_Position = outline(samples - 1, samples, 1.0);
+        } else {
+            gl_Position = COLLAPSED;
+        }
+        return;
+    }
+    
+    // Cap: the last body vertex again, the center, then (center, edge) pairs
+    int c = v - bodyVertices;
+    if (c == 0) {
+        gl_Position = (samples == uSamples) ? outline(samples - 1, samples, 1.0) : COLLAPSED;
+    } else if (!capped) {
+        gl_Position = COLLAPSED;
+    } else if (c == 1 || (c & 1) == 0) {
+        vEdge = vec4(0.0, 0.0, halfWidth, -1.0) / max(uFringe, 1e-30);
+        gl_Position = uMVP * vec4(aP0, 0.0, 1.0);
+    } else {
+        // With a fringe the polygon goes around the circle, so the fragment
+        // shader gets to draw all of it
+        int k = min((c - 3) / 2, capSegments);
+        float angle = 2.0 * PI * float(k) / float(capSegments);
+        vec2 offset = vec2(cos(angle), sin(angle)) * (halfWidth + uFringe);
+        if (uFringe > 0.0) {
+            offset /= cos(PI / float(capSegments));
+        }
+        float along = hasBody ? dot(offset, normalize(bodyDirection)) : -1.0;
+        vEdge = vec4(offset, halfWidth, along) / max(uFringe, 1e-30);
+        gl_Position = uMVP * vec4(aP0 + offset, 0.0, 1.0);
+    }
+}
+)";
+
+static const char* segmentFragmentShaderSource = R"(
+#version 330 core
+in vec3 vColor;
+out vec4 FragColor;
+
+void main() {
+    FragColor = vec4(vColor, 1.0);
+}
+)";
+
+// Analytic antialiasing: coverage of a one-pixel box filter across the
+// outline, from the distance to the centerline. The half of a cap lying
+// over the body is left to the body, so no edge pixel is blended twice.
+static const char* segmentAnalyticFragmentShaderSource = R"(
+#version 330 core
+in vec3 vColor;
+in vec4 vEdge;
+out vec4 FragColor;
+
+void main() {
+    if (vEdge.w > 0.0) {
+        discard;
+    }
+    float distance = length(vEdge.xy);
+    float halfWidth = vEdge.z;
+    
+    // The second term only matters for strokes thinner than a pixel
+    float coverage = clamp(halfWidth - distance + 0.5, 0.0, 1.0) -
+                     clamp(-halfWidth - distance + 0.5, 0.0, 1.0);
+    FragColor = vec4(vColor, coverage);
+}
+)";
+
+// Composited mode: one triangle covering the window copies the static layer
+// texel for texel (the layer has the window's size, so no filtering)
+static const char* compositeVertexShaderSource = R"(
+#version 330 core
+void main() {
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(pos * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+static const char* compositeFragmentShaderSource = R"(
+#version 330 core
+uniform sampler2D uLayer;
+out vec4 FragColor;
+
+void main() {
+    FragColor = texelFetch(uLayer, ivec2(gl_FragCoord.xy), 0);
+}
+)";
+
+// Tile pyramid: cached tiles are textured quads placed in world space
+static const char* tileVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aUV;
+
+uniform mat4 uMVP;
+
+out vec2 vUV;
+
+void main() {
+    vUV = aUV;
+    gl_Position = uMVP * vec4(aPos, 0.0, 1.0);
+}
+)";
+
+static const char* tileFragmentShaderSource = R"(
+#version 330 core
+in vec2 vUV;
+out vec4 FragColor;
+
+uniform sampler2D uAtlas;
+
+void main() {
+    FragColor = texture(uAtlas, vUV);
+}
+)";
+
+// Identifies what a tile shows: strokes drawn into it, in order, at their revisions
+static uint64_t tileSignature(const StrokePool& strokes, const std::vector<size_t>& indices) {
+    uint64_t hash = 1469598103934665603ull;  // FNV-1a over 64-bit words
+    for (size_t i : indices) {
+        hash = (hash ^ strokes.getId(i)) * 1099511628211ull;
+        hash = (hash ^ strokes.getRevision(i)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+static GLuint compileProgram(const char* vertexSource, const char* fragmentSource) {
+    // Compile vertex shader
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
+    glCompileShader(vertexShader);
+    
+    // Check compilation
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
+        VS_ERROR(Render, "Vertex shader compilation failed:\n" << infoLog);
+    }
+    
+    // Compile fragment shader
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
+    glCompileShader(fragmentShader);
+    
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
+        VS_ERROR(Render, "Fragment shader compilation failed:\n" << infoLog);
+    }
+    
+    // Link shaders
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, nullptr, infoLog);
+        VS_ERROR(Render, "Shader program linking failed:\n" << infoLog);
+    }
+    
+    // Clean up
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    return program;
+}
+
 VectorRenderer::VectorRenderer() 
     : shaderProgram(0), vao(0), vbo(0), 
       windowWidth(800), windowHeight(600),
@@ -33,19 +326,33 @@ VectorRenderer::VectorRenderer()
 }
 
 VectorRenderer::~VectorRenderer() {
+    clearGeometryCache();
     if (vbo) glDeleteBuffers(1, &vbo);
     if (vao) glDeleteVertexArrays(1, &vao);
     if (shaderProgram) glDeleteProgram(shaderProgram);
+    if (batchBuffer.vbo) glDeleteBuffers(1, &batchBuffer.vbo);
+    if (batchVao) glDeleteVertexArrays(1, &batchVao);
+    if (batchProgram) glDeleteProgram(batchProgram);
+    if (segmentBuffer.vbo) glDeleteBuffers(1, &segmentBuffer.vbo);
+    if (segmentVao) glDeleteVertexArrays(1, &segmentVao);
+    if (segmentProgram) glDeleteProgram(segmentProgram);
+    if (liveStroke.vbo) glDeleteBuffers(1, &liveStroke.vbo);
+    releaseStaticLayer();
+    if (compositeVao) glDeleteVertexArrays(1, &compositeVao);
+    if (compositeProgram) glDeleteProgram(compositeProgram);
+    releaseTileCache();
+    if (tileProgram) glDeleteProgram(tileProgram);
 }
 
-bool VectorRenderer::initialize(int width, int height) {
+bool VectorRenderer::initialize(int width, int height, Antialiasing antialiasing) {
     windowWidth = width;
     windowHeight = height;
+    this->antialiasing = antialiasing;
     
     // Initialize GLEW
     glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK) {
-        std::cerr << "Failed to initialize GLEW" << std::endl;
+        VS_ERROR(Render, "Failed to initialize GLEW");
         return false;
     }
     
@@ -66,6 +373,28 @@ bool VectorRenderer::initialize(int width, int height) {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
     
+    // Batch and segment VAOs; attributes are bound when drawing, since the
+    // buffers move when they grow or are compacted
+    glGenVertexArrays(1, &batchVao);
+    glGenVertexArrays(1, &segmentVao);
+    batchBuffer.elementSize = sizeof(BatchVertex);
+    segmentBuffer.elementSize = sizeof(SegmentRecord);
+    segmentBuffer.padding = 1;  // The last record's instance reads one record ahead
+    
+    // The composite pass has no vertex attributes, but core profiles
+    // still need a VAO bound to draw
+    glGenVertexArrays(1, &compositeVao);
+    
+    // The static layer uses the window's sample count so it looks the same
+    // as strokes drawn straight to the window
+    GLint maxSamples = 0;
+    glGetIntegerv(GL_SAMPLES, &windowSamples);
+    glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+    windowSamples = std::min(windowSamples, maxSamples);
+    if (antialiasing == Antialiasing::Analytic && windowSamples > 1) {
+        VS_WARN(Render, "Analytic antialiasing on a " << windowSamples << "x multisampled window");
+    }
+    
     // Set up OpenGL state
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -78,50 +407,30 @@ bool VectorRenderer::initialize(int width, int height) {
 }
 
 void VectorRenderer::createShaders() {
-    // Compile vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    
-    // Check compilation
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        std::cerr << "Vertex shader compilation failed:\n" << infoLog << std::endl;
-    }
-    
-    // Compile fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        std::cerr << "Fragment shader compilation failed:\n" << infoLog << std::endl;
-    }
-    
-    // Link shaders
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-        std::cerr << "Shader program linking failed:\n" << infoLog << std::endl;
-    }
-    
-    // Clean up
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    shaderProgram = compileProgram(vertexShaderSource, fragmentShaderSource);
+    batchProgram = compileProgram(batchVertexShaderSource, batchFragmentShaderSource);
     
     // Get uniform locations
     uMVP = glGetUniformLocation(shaderProgram, "uMVP");
     uColor = glGetUniformLocation(shaderProgram, "uColor");
+    uBatchMVP = glGetUniformLocation(batchProgram, "uMVP");
+    
+    segmentProgram = compileProgram(segmentVertexShaderSource,
+                                    (antialiasing == Antialiasing::Analytic) ? segmentAnalyticFragmentShaderSource
+                                                                             : segmentFragmentShaderSource);
+    uSegmentMVP = glGetUniformLocation(segmentProgram, "uMVP");
+    uSegmentSamples = glGetUniformLocation(segmentProgram, "uSamples");
+    uSegmentCapSegments = glGetUniformLocation(segmentProgram, "uCapSegments");
+    uSegmentPixelsPerUnit = glGetUniformLocation(segmentProgram, "uPixelsPerUnit");
+    uSegmentTolerance = glGetUniformLocation(segmentProgram, "uTolerance");
+    uSegmentFringe = glGetUniformLocation(segmentProgram, "uFringe");
+    
+    compositeProgram = compileProgram(compositeVertexShaderSource, compositeFragmentShaderSource);
+    uCompositeLayer = glGetUniformLocation(compositeProgram, "uLayer");
+    
+    tileProgram = compileProgram(tileVertexShaderSource, tileFragmentShaderSource);
+    uTileMVP = glGetUniformLocation(tileProgram, "uMVP");
+    uTileAtlas = glGetUniformLocation(tileProgram, "uAtlas");
 }
 
 void VectorRenderer::updateProjection() {
@@ -135,53 +444,1159 @@ void VectorRenderer::beginFrame() {
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f); // White background
     glClear(GL_COLOR_BUFFER_BIT);
     
+    frameBounds = getVisibleBounds();
+    frameDetailLevel = computeDetailLevel();
+    framePixelSize = 1.0f / std::max(getViewScale(), 1e-6f);
+    frameDotCells.clear();
+    staticLayerReused = false;
+    
+    // Compact between frames so queued slot offsets never move mid-frame
+    for (SlotBuffer* buffer : {&batchBuffer, &segmentBuffer}) {
+        if (buffer->garbage > BATCH_COMPACT_MIN_GARBAGE && buffer->garbage > buffer->used / 2) {
+            compactSlotBuffer(*buffer);
+        }
+    }
+    
     glUseProgram(shaderProgram);
 }
 
-void VectorRenderer::renderStroke(const Stroke& stroke) {
+void VectorRenderer::renderStroke(const StrokeView& stroke) {
     if (stroke.isEmpty()) return;
+    if (!frameBounds.intersects(stroke.getBounds())) return;
+    
+    // CPU strips carry no distance to the centerline
+    if (antialiasing == Antialiasing::Analytic) {
+        queueSegmentStroke(stroke);
+        drawSegmentRuns();
+        return;
+    }
+    
+    // Reuse the cached triangle strip unless the stroke changed since it was built
+    StrokeGeometry& geometry = geometryCache[stroke.getId()];
+    if (geometry.vbo == 0 || geometry.revision != stroke.getRevision() ||
+        geometry.detailLevel != frameDetailLevel || geometry.levelOfDetail != stroke.getLevelOfDetail()) {
+        buildGeometry(stroke, geometry);
+    }
+    geometry.lastUsedFrame = frameIndex;
+    
+    if (geometry.vertexCount < 4) {
+        return;
+    }
     
+    // Set uniforms
+    glm::mat4 mvp = projectionMatrix * viewTransform;
+    glUniformMatrix4fv(uMVP, 1, GL_FALSE, &mvp[0][0]);
+    
+    glm::vec3 color = stroke.getColor();
+    glUniform3f(uColor, color.r, color.g, color.b);
+    
+    // No need for glLineWidth - width is in the geometry!
+    // When you zoom, the entire triangle strip scales, maintaining visual thickness
+    
+    // Draw as triangle strip
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, geometry.vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, geometry.vertexCount);
+    glBindVertexArray(0);
+}
+
+std::vector<glm::vec2> VectorRenderer::tessellate(const StrokeView& stroke) const {
     // Smooth the stroke into Bézier curves
     auto segments = BezierSmoother::smooth(stroke);
-    if (segments.empty()) return;
+    if (segments.empty()) return {};
     
-    std::cout << "Rendering stroke: " << stroke.getPointCount() << " points, " 
-              << segments.size() << " segments" << std::endl;
+    VS_TRACE(Render, "Rendering stroke: " << stroke.getPointCount() << " points, "
+            << segments.size() << " segments");
     
     // Generate triangle strip vertices with proper width
     // The width is baked into the geometry, so it will scale with zoom automatically
-    auto vertices = BezierSmoother::generateTriangleStrip(segments, stroke.getBaseWidth(), 15);
+    std::vector<glm::vec2> vertices;
+    if (tessellationMode == TessellationMode::Adaptive) {
+        float pixelsPerUnit = std::ldexp(1.0f, frameDetailLevel);
+        vertices = BezierSmoother::generateTriangleStripAdaptive(segments, stroke.getBaseWidth(),
+                                                                 pixelsPerUnit, tessellationTolerance);
+    } else {
+        vertices = BezierSmoother::generateTriangleStrip(segments, stroke.getBaseWidth(), 15);
+    }
     
-    std::cout << "Generated " << vertices.size() << " vertices" << std::endl;
+    VS_TRACE(Render, "Generated " << vertices.size() << " vertices");
     
     if (vertices.size() < 4) {
-        std::cout << "Too few vertices, skipping" << std::endl;
+        VS_TRACE(Render, "Too few vertices, skipping");
+        return {};
+    }
+    
+    return vertices;
+}
+
+void VectorRenderer::renderLiveStroke(const Stroke& stroke) {
+    if (stroke.isEmpty()) return;
+    
+    if (antialiasing == Antialiasing::Analytic) {
+        if (liveStroke.id != stroke.getId() || liveStroke.revision != stroke.getRevision()) {
+            updateLiveSegments(stroke);
+        }
+        const GLint first = 0;
+        const GLsizei count = static_cast<GLsizei>(liveStroke.records.size());
+        if (count >= 2) {
+            drawSegmentRecords(liveStroke.vbo, &first, &count, 1);
+        }
         return;
     }
     
-    // Upload to GPU
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), 
-                 vertices.data(), GL_DYNAMIC_DRAW);
+    if (liveStroke.id != stroke.getId() || liveStroke.revision != stroke.getRevision() ||
+        liveStroke.detailLevel != frameDetailLevel) {
+        if (!updateLiveStroke(stroke)) {
+            // Dots (a click without movement) use the regular path
+            renderStroke(stroke);
+            return;
+        }
+    }
+    
+    if (liveStroke.vertices.size() < 4) return;
     
-    // Set uniforms
     glm::mat4 mvp = projectionMatrix * viewTransform;
     glUniformMatrix4fv(uMVP, 1, GL_FALSE, &mvp[0][0]);
     
     glm::vec3 color = stroke.getColor();
     glUniform3f(uColor, color.r, color.g, color.b);
     
-    // No need for glLineWidth - width is in the geometry!
-    // When you zoom, the entire triangle strip scales, maintaining visual thickness
-    
-    // Draw as triangle strip
     glBindVertexArray(vao);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices.size());
+    glBindBuffer(GL_ARRAY_BUFFER, liveStroke.vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, static_cast<GLsizei>(liveStroke.vertices.size()));
     glBindVertexArray(0);
 }
 
+bool VectorRenderer::updateLiveStroke(const Stroke& stroke) {
+    LiveStroke& live = liveStroke;
+    const bool adaptive = (tessellationMode == TessellationMode::Adaptive);
+    const float halfWidth = stroke.getBaseWidth() * 0.5f;
+    const float pixelsPerUnit = std::ldexp(1.0f, frameDetailLevel);
+    
+    // New stroke, new width or new zoom octave: start over
+    if (live.id != stroke.getId() || live.detailLevel != frameDetailLevel ||
+        live.baseWidth != stroke.getBaseWidth()) {
+        live.id = stroke.getId();
+        live.detailLevel = frameDetailLevel;
+        live.baseWidth = stroke.getBaseWidth();
+        live.capSegments = adaptive
+            ? BezierSmoother::circleSegmentCount(halfWidth * pixelsPerUnit, tessellationTolerance)
+            : 16;
+        live.segments.clear();
+        live.segmentStarts.clear();
+        live.centerPoints.clear();
+        live.vertices.clear();
+    }
+    live.revision = stroke.getRevision();
+    
+    size_t firstSegment = BezierSmoother::smoothIncremental(stroke, live.segments);
+    if (live.segments.size() == 1 &&
+        glm::length(live.segments[0].p1 - live.segments[0].p0) < 0.001f) {
+        live.vertices.clear();
+        live.revision = 0;  // Retry next frame; the dot is drawn by renderStroke
+        return false;
+    }
+    
+    // Re-sample the centerline from the first changed segment on
+    size_t firstSample = (firstSegment < live.segmentStarts.size())
+        ? live.segmentStarts[firstSegment]
+        : live.centerPoints.size();
+    if (firstSegment == 0) firstSample = 0;
+    live.segmentStarts.resize(std::min(firstSegment, live.segmentStarts.size()));
+    live.centerPoints.resize(firstSample);
+    
+    for (size_t i = firstSegment; i < live.segments.size(); ++i) {
+        const BezierSegment& segment = live.segments[i];
+        int samples = adaptive
+            ? BezierSmoother::segmentSampleCount(segment, halfWidth, pixelsPerUnit, tessellationTolerance)
+            : 15;
+        // Adaptive strips share segment endpoints, fixed ones repeat them
+        int first = (adaptive && i > 0) ? 1 : 0;
+        
+        live.segmentStarts.push_back(live.centerPoints.size());
+        for (int j = first; j < samples; ++j) {
+            float t = static_cast<float>(j) / static_cast<float>(samples - 1);
+            live.centerPoints.push_back(BezierSmoother::evaluateCubic(segment, t));
+        }
+    }
+    
+    const auto& centers = live.centerPoints;
+    const size_t headCount = 2 * (live.capSegments + 1) + 2;
+    
+    // The normal just before the first new sample also changes
+    size_t dirtySample = (firstSample > 0) ? firstSample - 1 : 0;
+    size_t dirtyVertex = (dirtySample > 0) ? headCount + 2 * dirtySample : 0;
+    live.vertices.resize(dirtyVertex);
+    
+    if (dirtyVertex == 0) {
+        // Start cap plus the degenerate join into the body
+        glm::vec2 startLeft = centers[0] - BezierSmoother::centerlineNormal(centers, 0) * halfWidth;
+        BezierSmoother::appendCircle(live.vertices, centers[0], halfWidth, live.capSegments);
+        live.vertices.push_back(startLeft);
+        live.vertices.push_back(startLeft);
+    }
+    
+    for (size_t k = dirtySample; k < centers.size(); ++k) {
+        glm::vec2 normal = BezierSmoother::centerlineNormal(centers, k);
+        live.vertices.push_back(centers[k] - normal * halfWidth);
+        live.vertices.push_back(centers[k] + normal * halfWidth);
+    }
+    
+    // End cap follows the body, so it is rewritten every update
+    glm::vec2 endCenter = centers.back();
+    glm::vec2 endRight = endCenter + BezierSmoother::centerlineNormal(centers, centers.size() - 1) * halfWidth;
+    live.vertices.push_back(endRight);
+    live.vertices.push_back(endRight);
+    live.vertices.push_back(endCenter);
+    BezierSmoother::appendCircle(live.vertices, endCenter, halfWidth, live.capSegments);
+    
+    // Upload only what changed; grow geometrically so appends stay amortized O(1)
+    GLsizei total = static_cast<GLsizei>(live.vertices.size());
+    if (live.vbo == 0) {
+        glGenBuffers(1, &live.vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, live.vbo);
+    if (total > live.capacity) {
+        live.capacity = std::max(total * 2, LIVE_MIN_CAPACITY);
+        glBufferData(GL_ARRAY_BUFFER, live.capacity * sizeof(glm::vec2), nullptr, GL_DYNAMIC_DRAW);
+        dirtyVertex = 0;
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, dirtyVertex * sizeof(glm::vec2),
+                    (total - dirtyVertex) * sizeof(glm::vec2), live.vertices.data() + dirtyVertex);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploadedBytes += (total - dirtyVertex) * sizeof(glm::vec2);
+    
+    return true;
+}
+
+void VectorRenderer::updateLiveSegments(const Stroke& stroke) {
+    LiveStroke& live = liveStroke;
+    
+    // Records bake in width and color, which only change between strokes
+    if (live.id != stroke.getId() || live.baseWidth != stroke.getBaseWidth() || live.color != stroke.getColor()) {
+        live.id = stroke.getId();
+        live.baseWidth = stroke.getBaseWidth();
+        live.color = stroke.getColor();
+        live.segments.clear();
+        live.records.clear();
+    }
+    live.revision = stroke.getRevision();
+    
+    // The old closing record becomes a segment, so rewrite from there on
+    size_t firstSegment = BezierSmoother::smoothIncremental(stroke, live.segments);
+    firstSegment = std::min(firstSegment, live.records.size());
+    live.records.resize(firstSegment);
+    appendSegmentRecords(live.records, live.segments, firstSegment, live.baseWidth, live.color);
+    
+    // One spare record: the closing record's instance reads one ahead
+    GLsizei total = static_cast<GLsizei>(live.records.size());
+    GLsizei dirty = static_cast<GLsizei>(firstSegment);
+    if (live.vbo == 0) {
+        glGenBuffers(1, &live.vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, live.vbo);
+    if (total + 1 > live.capacity) {
+        live.capacity = std::max(total * 2, LIVE_MIN_CAPACITY);
+        glBufferData(GL_ARRAY_BUFFER, live.capacity * sizeof(SegmentRecord), nullptr, GL_DYNAMIC_DRAW);
+        dirty = 0;
+    }
+    if (total > dirty) {
+        glBufferSubData(GL_ARRAY_BUFFER, dirty * sizeof(SegmentRecord), (total - dirty) * sizeof(SegmentRecord),
+                        live.records.data() + dirty);
+        uploadedBytes += (total - dirty) * sizeof(SegmentRecord);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+int VectorRenderer::computeDetailLevel() const {
+    if (tessellationMode != TessellationMode::Adaptive) {
+        return 0;
+    }
+    // Round up so cached geometry is never coarser than the tolerance allows
+    float scale = std::max(getViewScale(), 1e-6f);
+    return std::clamp(static_cast<int>(std::ceil(std::log2(scale))), -MAX_DETAIL_LEVEL, MAX_DETAIL_LEVEL);
+}
+
+void VectorRenderer::buildGeometry(const StrokeView& stroke, StrokeGeometry& geometry) {
+    geometry.revision = stroke.getRevision();
+    geometry.detailLevel = frameDetailLevel;
+    geometry.levelOfDetail = stroke.getLevelOfDetail();
+    geometry.vertexCount = 0;
+    if (geometry.vbo == 0) {
+        glGenBuffers(1, &geometry.vbo);
+    }
+    
+    auto vertices = tessellate(stroke);
+    if (vertices.empty()) return;
+    
+    // Upload once; the buffer is only rewritten when the stroke changes
+    glBindBuffer(GL_ARRAY_BUFFER, geometry.vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec2), 
+                 vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    uploadedBytes += vertices.size() * sizeof(glm::vec2);
+    
+    geometry.vertexCount = static_cast<GLsizei>(vertices.size());
+}
+
+void VectorRenderer::evictStaleGeometry() {
+    // Strokes removed by undo/clear/load stop being drawn; free their buffers
+    for (auto it = geometryCache.begin(); it != geometryCache.end();) {
+        if (frameIndex - it->second.lastUsedFrame > GEOMETRY_MAX_IDLE_FRAMES) {
+            glDeleteBuffers(1, &it->second.vbo);
+            it = geometryCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    for (SlotBuffer* buffer : {&batchBuffer, &segmentBuffer}) {
+        for (auto it = buffer->slots.begin(); it != buffer->slots.end();) {
+            if (frameIndex - it->second.lastUsedFrame > GEOMETRY_MAX_IDLE_FRAMES) {
+                buffer->garbage += it->second.count;
+                it = buffer->slots.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void VectorRenderer::clearGeometryCache() {
+    for (auto& entry : geometryCache) {
+        if (entry.second.vbo) glDeleteBuffers(1, &entry.second.vbo);
+    }
+    geometryCache.clear();
+    
+    // Keep the slot buffer allocations, forget their contents
+    for (SlotBuffer* buffer : {&batchBuffer, &segmentBuffer}) {
+        buffer->slots.clear();
+        buffer->used = 0;
+        buffer->garbage = 0;
+    }
+}
+
+void VectorRenderer::submitStroke(const StrokeView& stroke) {
+    if (antialiasing == Antialiasing::Analytic || renderMode == RenderMode::GpuExpanded) {
+        queueSegmentStroke(stroke);
+    } else if (renderMode == RenderMode::Batched) {
+        queueBatchStroke(stroke);
+    } else {
+        renderStroke(stroke);
+    }
+}
+
+void VectorRenderer::submitStroke(const StrokePool& strokes, size_t index) {
+    if (!strokeSimplification) {
+        submitStroke(strokes.view(index));
+        return;
+    }
+    if (!frameBounds.intersects(strokes.getBounds(index))) return;
+    
+    StrokeView stroke = strokes.simplifiedView(index, framePixelSize);
+    if (stroke.getLevelOfDetail() == StrokePool::LOD_DOT) {
+        // Skip it when the last sub-pixel stroke drawn into this pixel had
+        // the same color; a different color still goes on top
+        glm::vec4 screen = viewTransform * glm::vec4(stroke.getPosition(0), 0.0f, 1.0f);
+        uint64_t cell = (static_cast<uint64_t>(static_cast<uint32_t>(static_cast<int32_t>(std::floor(screen.x)))) << 32) |
+                        static_cast<uint32_t>(static_cast<int32_t>(std::floor(screen.y)));
+        glm::vec3 color = glm::clamp(stroke.getColor(), glm::vec3(0.0f), glm::vec3(1.0f)) * 255.0f;
+        uint32_t packed = (static_cast<uint32_t>(color.r + 0.5f) << 16) |
+                          (static_cast<uint32_t>(color.g + 0.5f) << 8) |
+                          static_cast<uint32_t>(color.b + 0.5f);
+        auto [it, inserted] = frameDotCells.try_emplace(cell, packed);
+        if (!inserted) {
+            if (it->second == packed) return;
+            it->second = packed;
+        }
+    }
+    submitStroke(stroke);
+}
+
+void VectorRenderer::setRenderMode(RenderMode mode) {
+    if (renderMode == mode) return;
+    renderMode = mode;
+    redrawNeeded = true;
+    
+    // Cached pictures were drawn by the other path
+    staticLayer.valid = false;
+    releaseTileCache();
+}
+
+void VectorRenderer::setTessellationMode(TessellationMode mode) {
+    if (tessellationMode == mode) return;
+    tessellationMode = mode;
+    invalidateTessellation();
+}
+
+void VectorRenderer::setTessellationTolerance(float pixels) {
+    if (tessellationTolerance == pixels) return;
+    tessellationTolerance = pixels;
+    invalidateTessellation();
+}
+
+void VectorRenderer::invalidateTessellation() {
+    redrawNeeded = true;
+    
+    // Cached strips are keyed on stroke revision and detail level only,
+    // which both modes share at zoom 1
+    clearGeometryCache();
+    liveStroke.revision = 0;
+}
+
+void VectorRenderer::setStrokeSimplification(bool enabled) {
+    if (strokeSimplification == enabled) return;
+    strokeSimplification = enabled;
+    redrawNeeded = true;
+    
+    // Cached pictures were drawn with the other setting
+    staticLayer.valid = false;
+    releaseTileCache();
+}
+
+void VectorRenderer::queueBatchStroke(const StrokeView& stroke) {
+    if (stroke.isEmpty()) return;
+    if (!frameBounds.intersects(stroke.getBounds())) return;
+    
+    BatchSlot& slot = batchBuffer.slots[stroke.getId()];
+    slot.lastUsedFrame = frameIndex;
+    
+    if (slot.revision != stroke.getRevision() || slot.detailLevel != frameDetailLevel ||
+        slot.levelOfDetail != stroke.getLevelOfDetail()) {
+        slot.revision = stroke.getRevision();
+        slot.detailLevel = frameDetailLevel;
+        slot.levelOfDetail = stroke.getLevelOfDetail();
+        
+        auto vertices = tessellate(stroke);
+        glm::vec3 color = glm::clamp(stroke.getColor(), glm::vec3(0.0f), glm::vec3(1.0f));
+        GLubyte r = static_cast<GLubyte>(color.r * 255.0f + 0.5f);
+        GLubyte g = static_cast<GLubyte>(color.g * 255.0f + 0.5f);
+        GLubyte b = static_cast<GLubyte>(color.b * 255.0f + 0.5f);
+        
+        std::vector<BatchVertex> packed(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            packed[i] = BatchVertex{vertices[i], {r, g, b, 255}};
+        }
+        writeSlot(batchBuffer, slot, packed.data(), static_cast<GLsizei>(packed.size()));
+    }
+    
+    if (slot.count < 4) return;
+    
+    batchFirsts.push_back(slot.first);
+    batchCounts.push_back(slot.count);
+}
+
+void VectorRenderer::queueSegmentStroke(const StrokeView& stroke) {
+    if (stroke.isEmpty()) return;
+    if (!frameBounds.intersects(stroke.getBounds())) return;
+    
+    BatchSlot& slot = segmentBuffer.slots[stroke.getId()];
+    slot.lastUsedFrame = frameIndex;
+    
+    // Records don't depend on the zoom, only on the stroke
+    if (slot.count == 0 || slot.revision != stroke.getRevision() ||
+        slot.levelOfDetail != stroke.getLevelOfDetail()) {
+        slot.revision = stroke.getRevision();
+        slot.levelOfDetail = stroke.getLevelOfDetail();
+        
+        auto segments = BezierSmoother::smooth(stroke);
+        std::vector<SegmentRecord> records;
+        records.reserve(segments.size() + 1);
+        appendSegmentRecords(records, segments, 0, stroke.getBaseWidth(), stroke.getColor());
+        writeSlot(segmentBuffer, slot, records.data(), static_cast<GLsizei>(records.size()));
+    }
+    
+    if (slot.count < 2) return;
+    
+    // Extend the previous run when this slot directly follows it
+    if (!segmentFirsts.empty() && segmentFirsts.back() + segmentCounts.back() == slot.first) {
+        segmentCounts.back() += slot.count;
+    } else {
+        segmentFirsts.push_back(slot.first);
+        segmentCounts.push_back(slot.count);
+    }
+}
+
+void VectorRenderer::appendSegmentRecords(std::vector<SegmentRecord>& records,
+                                          const std::vector<BezierSegment>& segments, size_t firstSegment,
+                                          float width, const glm::vec3& color) {
+    if (segments.empty()) return;
+    
+    glm::vec3 clamped = glm::clamp(color, glm::vec3(0.0f), glm::vec3(1.0f));
+    GLubyte r = static_cast<GLubyte>(clamped.r * 255.0f + 0.5f);
+    GLubyte g = static_cast<GLubyte>(clamped.g * 255.0f + 0.5f);
+    GLubyte b = static_cast<GLubyte>(clamped.b * 255.0f + 0.5f);
+    
+    // Outlines keep the stroke's base width, like the CPU strips
+    for (size_t i = firstSegment; i < segments.size(); ++i) {
+        const BezierSegment& segment = segments[i];
+        GLubyte flag = (i == 0) ? 255 : 128;
+        records.push_back(SegmentRecord{segment.p0, segment.c1, segment.c2, width, {r, g, b, flag}});
+    }
+    
+    // The closing record points its cap at the last control point off the end
+    const glm::vec2 end = segments.back().p1;
+    glm::vec2 before = end;
+    for (auto it = segments.rbegin(); it != segments.rend() && before == end; ++it) {
+        for (const glm::vec2& point : {it->c2, it->c1, it->p0}) {
+            if (point != end) {
+                before = point;
+                break;
+            }
+        }
+    }
+    records.push_back(SegmentRecord{end, before, before, width, {r, g, b, 0}});
+}
+
+void VectorRenderer::writeSlot(SlotBuffer& buffer, BatchSlot& slot, const void* data, GLsizei count) {
+    if (count <= slot.count) {
+        // Fits in the old slot (a moved stroke keeps its size)
+        buffer.garbage += slot.count - count;
+    } else {
+        buffer.garbage += slot.count;
+        reserveSlotCapacity(buffer, buffer.used + count);
+        slot.first = buffer.used;
+        buffer.used += count;
+    }
+    slot.count = count;
+    
+    if (count > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, slot.first * buffer.elementSize, count * buffer.elementSize, data);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        uploadedBytes += count * buffer.elementSize;
+    }
+}
+
+void VectorRenderer::reserveSlotCapacity(SlotBuffer& buffer, GLsizei count) {
+    if (count + buffer.padding <= buffer.capacity) return;
+    
+    GLsizei newCapacity = std::max({count + buffer.padding, buffer.capacity * 2, BATCH_MIN_CAPACITY});
+    
+    GLuint newVbo;
+    glGenBuffers(1, &newVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, newVbo);
+    glBufferData(GL_ARRAY_BUFFER, newCapacity * buffer.elementSize, nullptr, GL_DYNAMIC_DRAW);
+    
+    // Carry existing slots over on the GPU, no CPU round trip
+    if (buffer.vbo) {
+        if (buffer.used > 0) {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer.vbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                                buffer.used * buffer.elementSize);
+        }
+        glDeleteBuffers(1, &buffer.vbo);
+    }
+    buffer.vbo = newVbo;
+    buffer.capacity = newCapacity;
+}
+
+void VectorRenderer::bindBatchAttributes() {
+    glBindVertexArray(batchVao);
+    glBindBuffer(GL_ARRAY_BUFFER, batchBuffer.vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(BatchVertex),
+                          (void*)offsetof(BatchVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(BatchVertex),
+                          (void*)offsetof(BatchVertex, color));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VectorRenderer::compactSlotBuffer(SlotBuffer& buffer) {
+    GLuint newVbo;
+    glGenBuffers(1, &newVbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, buffer.capacity * buffer.elementSize, nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer.vbo);
+    
+    // Keep the slots in buffer order, so strokes that were drawn as one run still are
+    std::vector<BatchSlot*> ordered;
+    ordered.reserve(buffer.slots.size());
+    for (auto& entry : buffer.slots) {
+        ordered.push_back(&entry.second);
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const BatchSlot* a, const BatchSlot* b) { return a->first < b->first; });
+    
+    GLsizei used = 0;
+    for (BatchSlot* slot : ordered) {
+        if (slot->count > 0) {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                slot->first * buffer.elementSize, used * buffer.elementSize,
+                                slot->count * buffer.elementSize);
+        }
+        slot->first = used;
+        used += slot->count;
+    }
+    
+    glDeleteBuffers(1, &buffer.vbo);
+    buffer.vbo = newVbo;
+    buffer.used = used;
+    buffer.garbage = 0;
+}
+
+void VectorRenderer::flushBatch() {
+    drawSegmentRuns();
+    if (batchFirsts.empty()) return;
+    
+    glm::mat4 mvp = projectionMatrix * viewTransform;
+    
+    // Strokes are drawn in submission order, so later strokes (and eraser
+    // strokes) still paint over earlier ones
+    glUseProgram(batchProgram);
+    glUniformMatrix4fv(uBatchMVP, 1, GL_FALSE, &mvp[0][0]);
+    bindBatchAttributes();
+    glBindVertexArray(batchVao);
+    glMultiDrawArrays(GL_TRIANGLE_STRIP, batchFirsts.data(), batchCounts.data(),
+                      static_cast<GLsizei>(batchFirsts.size()));
+    glBindVertexArray(0);
+    glUseProgram(shaderProgram);
+    
+    batchFirsts.clear();
+    batchCounts.clear();
+}
+
+void VectorRenderer::drawSegmentRuns() {
+    if (segmentFirsts.empty()) return;
+    
+    drawSegmentRecords(segmentBuffer.vbo, segmentFirsts.data(), segmentCounts.data(), segmentFirsts.size());
+    segmentFirsts.clear();
+    segmentCounts.clear();
+}
+
+void VectorRenderer::drawSegmentRecords(GLuint buffer, const GLint* firsts, const GLsizei* counts, size_t runs) {
+    glm::mat4 mvp = projectionMatrix * viewTransform;
+    const bool adaptive = (tessellationMode == TessellationMode::Adaptive);
+    const int samples = adaptive ? GPU_MAX_SAMPLES : GPU_FIXED_SAMPLES;
+    const GLsizei verticesPerSegment = 2 * samples + 2 + 2 * (GPU_CAP_SEGMENTS + 1);
+    
+    glUseProgram(segmentProgram);
+    glUniformMatrix4fv(uSegmentMVP, 1, GL_FALSE, &mvp[0][0]);
+    glUniform1i(uSegmentSamples, samples);
+    glUniform1i(uSegmentCapSegments, GPU_CAP_SEGMENTS);
+    glUniform1f(uSegmentPixelsPerUnit, adaptive ? 1.0f / framePixelSize : 0.0f);
+    glUniform1f(uSegmentTolerance, tessellationTolerance);
+    glUniform1f(uSegmentFringe, (antialiasing == Antialiasing::Analytic) ? framePixelSize : 0.0f);
+    
+    glBindVertexArray(segmentVao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (GLuint location = 0; location < 7; ++location) {
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    
+    // Without base instances (GL 4.2), each run points the attributes at its first record
+    const GLsizei stride = sizeof(SegmentRecord);
+    for (size_t run = 0; run < runs; ++run) {
+        const size_t base = static_cast<size_t>(firsts[run]) * stride;
+        const size_t next = base + stride;
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SegmentRecord, p0)));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SegmentRecord, c1)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SegmentRecord, c2)));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(base + offsetof(SegmentRecord, width)));
+        glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)(base + offsetof(SegmentRecord, color)));
+        glVertexAttribPointer(5, 2, GL_FLOAT, GL_FALSE, stride, (void*)(next + offsetof(SegmentRecord, p0)));
+        glVertexAttribPointer(6, 1, GL_FLOAT, GL_FALSE, stride, (void*)(next + offsetof(SegmentRecord, width)));
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, verticesPerSegment, counts[run]);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(shaderProgram);
+}
+
+void VectorRenderer::setCompositing(bool enabled) {
+    compositing = enabled;
+    redrawNeeded = true;
+    if (!compositing) {
+        releaseStaticLayer();
+    }
+}
+
+bool VectorRenderer::beginStaticLayer(uint64_t contentVersion, const BoundingBox& damage) {
+    if (!compositing || !ensureStaticLayerTargets()) {
+        return true;
+    }
+    
+    // Anything that changes the picture of the committed strokes
+    StaticLayer& layer = staticLayer;
+    const bool samePicture = layer.valid && layer.viewTransform == viewTransform &&
+        layer.tessellationMode == tessellationMode && layer.tessellationTolerance == tessellationTolerance;
+    if (samePicture && layer.contentVersion == contentVersion) {
+        layer.redrawing = false;
+        staticLayerReused = true;
+        return false;
+    }
+    
+    // Only the strokes changed: redraw the damaged rectangle, widened by a
+    // couple of pixels for antialiasing and rounding
+    layer.patching = false;
+    if (samePicture && !damage.isEmpty()) {
+        const glm::vec4 a = viewTransform * glm::vec4(damage.min, 0.0f, 1.0f);
+        const glm::vec4 b = viewTransform * glm::vec4(damage.max, 0.0f, 1.0f);
+        const float margin = 2.0f;
+        const int x0 = std::max(static_cast<int>(std::floor(std::min(a.x, b.x) - margin)), 0);
+        const int x1 = std::min(static_cast<int>(std::ceil(std::max(a.x, b.x) + margin)), layer.width);
+        const int y0 = std::max(static_cast<int>(std::floor(std::min(a.y, b.y) - margin)), 0);
+        const int y1 = std::min(static_cast<int>(std::ceil(std::max(a.y, b.y) + margin)), layer.height);
+        
+        // Changes outside the view leave the picture as it is
+        layer.contentVersion = contentVersion;
+        if (x0 >= x1 || y0 >= y1) {
+            layer.redrawing = false;
+            staticLayerReused = true;
+            return false;
+        }
+        
+        // Window y grows downwards, framebuffer rows upwards
+        layer.patching = true;
+        layer.scissorRect = glm::ivec4(x0, layer.height - y1, x1 - x0, y1 - y0);
+        frameBounds = BoundingBox(screenToWorld(glm::vec2(x0, y0)), screenToWorld(glm::vec2(x1, y1)));
+    }
+    
+    layer.valid = true;
+    layer.redrawing = true;
+    layer.contentVersion = contentVersion;
+    layer.viewTransform = viewTransform;
+    layer.tessellationMode = tessellationMode;
+    layer.tessellationTolerance = tessellationTolerance;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.msaaFbo ? layer.msaaFbo : layer.fbo);
+    if (layer.patching) {
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(layer.scissorRect.x, layer.scissorRect.y, layer.scissorRect.z, layer.scissorRect.w);
+    }
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    return true;
+}
+
+void VectorRenderer::endStaticLayer() {
+    StaticLayer& layer = staticLayer;
+    if (!compositing || layer.fbo == 0) {
+        return;
+    }
+    
+    // A patch resolves only its rectangle, since the scissor is still on
+    if (layer.redrawing && layer.msaaFbo) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, layer.msaaFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, layer.fbo);
+        glBlitFramebuffer(0, 0, layer.width, layer.height, 0, 0, layer.width, layer.height,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+    if (layer.patching) {
+        glDisable(GL_SCISSOR_TEST);
+        layer.patching = false;
+        frameBounds = getVisibleBounds();
+    }
+    layer.redrawing = false;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    // The layer is opaque (white background included), so it replaces the
+    // window contents without blending
+    glDisable(GL_BLEND);
+    glUseProgram(compositeProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glUniform1i(uCompositeLayer, 0);
+    glBindVertexArray(compositeVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glEnable(GL_BLEND);
+    glUseProgram(shaderProgram);
+}
+
+bool VectorRenderer::ensureStaticLayerTargets() {
+    StaticLayer& layer = staticLayer;
+    if (layer.fbo && layer.width == windowWidth && layer.height == windowHeight) {
+        return true;
+    }
+    releaseStaticLayer();
+    if (windowWidth <= 0 || windowHeight <= 0) {
+        return false;
+    }
+    
+    layer.width = windowWidth;
+    layer.height = windowHeight;
+    
+    glGenTextures(1, &layer.texture);
+    glBindTexture(GL_TEXTURE_2D, layer.texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, layer.width, layer.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glGenFramebuffers(1, &layer.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, layer.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layer.texture, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    
+    if (complete && windowSamples > 1) {
+        glGenRenderbuffers(1, &layer.msaaColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, layer.msaaColor);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, windowSamples, GL_RGBA8, layer.width, layer.height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        
+        glGenFramebuffers(1, &layer.msaaFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, layer.msaaFbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, layer.msaaColor);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    if (!complete) {
+        // Keep drawing straight to the window
+        VS_WARN(Render, "Static layer framebuffer incomplete, compositing disabled");
+        setCompositing(false);
+        return false;
+    }
+    return true;
+}
+
+void VectorRenderer::releaseStaticLayer() {
+    StaticLayer& layer = staticLayer;
+    if (layer.fbo) glDeleteFramebuffers(1, &layer.fbo);
+    if (layer.texture) glDeleteTextures(1, &layer.texture);
+    if (layer.msaaFbo) glDeleteFramebuffers(1, &layer.msaaFbo);
+    if (layer.msaaColor) glDeleteRenderbuffers(1, &layer.msaaColor);
+    layer = StaticLayer();
+}
+
+void VectorRenderer::setTileCaching(bool enabled) {
+    tileCaching = enabled;
+    redrawNeeded = true;
+    if (!tileCaching) {
+        releaseTileCache();
+    }
+}
+
+bool VectorRenderer::renderTiles(const StrokePool& strokes, const StrokeQuery& query) {
+    if (!tileCaching || !ensureTileAtlas()) {
+        return false;
+    }
+    
+    // Tessellation settings are baked into the tiles
+    if (tileTessellationMode != tessellationMode || tileTessellationTolerance != tessellationTolerance) {
+        tiles.clear();
+        freeTileSlots.clear();
+        for (int slot = tileSlotsPerRow * tileSlotsPerRow - 1; slot >= 0; --slot) {
+            freeTileSlots.push_back(slot);
+        }
+        tileTessellationMode = tessellationMode;
+        tileTessellationTolerance = tessellationTolerance;
+    }
+    
+    // Tiles are rendered at the power-of-two zoom at or above the current
+    // one, so they are shown at 0.5x to 1x and never noticeably magnified
+    // (the slack keeps zooming back to 1.0 with rounding error on level 0)
+    const float scale = std::max(getViewScale(), 1e-6f);
+    const int level = std::clamp(static_cast<int>(std::ceil(std::log2(scale) - 1e-4f)), -MAX_DETAIL_LEVEL, MAX_DETAIL_LEVEL);
+    const double tileWorld = std::ldexp(static_cast<double>(TILE_SIZE), -level);
+    
+    const int64_t x0 = static_cast<int64_t>(std::floor(frameBounds.min.x / tileWorld));
+    const int64_t x1 = static_cast<int64_t>(std::floor(frameBounds.max.x / tileWorld));
+    const int64_t y0 = static_cast<int64_t>(std::floor(frameBounds.min.y / tileWorld));
+    const int64_t y1 = static_cast<int64_t>(std::floor(frameBounds.max.y / tileWorld));
+    const int64_t slotCount = static_cast<int64_t>(tileSlotsPerRow) * tileSlotsPerRow;
+    if ((x1 - x0 + 1) * (y1 - y0 + 1) > slotCount) {
+        return false;
+    }
+    
+    ++tileFrame;
+    tileVertices.clear();
+    
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    bool renderedAny = false;
+    
+    const uint64_t poolVersion = strokes.getVersion();
+    const float atlasSize = static_cast<float>(tileAtlasSize);
+    
+    for (int64_t y = y0; y <= y1; ++y) {
+        for (int64_t x = x0; x <= x1; ++x) {
+            const TileKey key{level, x, y};
+            Tile& tile = tiles[key];
+            tile.lastUsedFrame = tileFrame;
+            
+            const glm::vec2 tileMin(static_cast<float>(x * tileWorld), static_cast<float>(y * tileWorld));
+            const glm::vec2 tileMax(static_cast<float>((x + 1) * tileWorld), static_cast<float>((y + 1) * tileWorld));
+            
+            // Only look at the strokes when the pool changed since the last check;
+            // the tile is redrawn only if the strokes it covers did
+            if (!tile.checked || tile.poolVersion != poolVersion) {
+                float pixel = static_cast<float>(tileWorld / TILE_SIZE);
+                std::vector<size_t> indices = query(BoundingBox(tileMin, tileMax).inflated(pixel));
+                uint64_t signature = tileSignature(strokes, indices);
+                
+                if (!tile.checked || signature != tile.signature) {
+                    if (indices.empty()) {
+                        if (tile.slot >= 0) freeTileSlots.push_back(tile.slot);
+                        tile.slot = -1;
+                    } else {
+                        if (tile.slot < 0) tile.slot = allocateTileSlot();
+                        if (tile.slot < 0) continue;  // Atlas full of visible tiles
+                        renderTile(key, tile.slot, strokes, indices);
+                        renderedAny = true;
+                    }
+                    tile.signature = signature;
+                }
+                tile.checked = true;
+                tile.poolVersion = poolVersion;
+            }
+            
+            if (tile.slot < 0) continue;
+            
+            // Sample texel centers only, so neighbouring atlas slots never bleed in
+            const float slotX = static_cast<float>((tile.slot % tileSlotsPerRow) * TILE_SIZE);
+            const float slotY = static_cast<float>((tile.slot / tileSlotsPerRow) * TILE_SIZE);
+            const float u0 = (slotX + 0.5f) / atlasSize;
+            const float u1 = (slotX + TILE_SIZE - 0.5f) / atlasSize;
+            const float vBottom = (slotY + 0.5f) / atlasSize;
+            const float vTop = (slotY + TILE_SIZE - 0.5f) / atlasSize;
+            
+            // World y grows downwards, texture rows upwards
+            TileVertex topLeft{tileMin, glm::vec2(u0, vTop)};
+            TileVertex topRight{glm::vec2(tileMax.x, tileMin.y), glm::vec2(u1, vTop)};
+            TileVertex bottomLeft{glm::vec2(tileMin.x, tileMax.y), glm::vec2(u0, vBottom)};
+            TileVertex bottomRight{tileMax, glm::vec2(u1, vBottom)};
+            tileVertices.insert(tileVertices.end(), {topLeft, bottomLeft, topRight, topRight, bottomLeft, bottomRight});
+        }
+    }
+    
+    if (renderedAny) {
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+        glViewport(0, 0, windowWidth, windowHeight);
+        if (staticLayer.patching) {
+            const glm::ivec4& rect = staticLayer.scissorRect;
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(rect.x, rect.y, rect.z, rect.w);
+        }
+    }
+    
+    // Forget empty tiles nobody has looked at recently
+    if (tiles.size() > static_cast<size_t>(slotCount) * 8) {
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (it->second.slot < 0 && it->second.lastUsedFrame != tileFrame) {
+                it = tiles.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    
+    drawTileQuads();
+    return true;
+}
+
+bool VectorRenderer::ensureTileAtlas() {
+    if (tileAtlas) return true;
+    
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+    tileAtlasSize = std::min(static_cast<int>(maxTextureSize), TILE_ATLAS_MAX_SIZE) / TILE_SIZE * TILE_SIZE;
+    if (tileAtlasSize < TILE_SIZE) {
+        setTileCaching(false);
+        return false;
+    }
+    tileSlotsPerRow = tileAtlasSize / TILE_SIZE;
+    
+    glGenTextures(1, &tileAtlas);
+    glBindTexture(GL_TEXTURE_2D, tileAtlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, tileAtlasSize, tileAtlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    
+    glGenFramebuffers(1, &tileAtlasFbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, tileAtlasFbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tileAtlas, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    
+    // Same antialiasing as strokes drawn straight to the window
+    if (complete && windowSamples > 1) {
+        glGenRenderbuffers(1, &tileMsaaColor);
+        glBindRenderbuffer(GL_RENDERBUFFER, tileMsaaColor);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, windowSamples, GL_RGBA8, TILE_SIZE, TILE_SIZE);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        
+        glGenFramebuffers(1, &tileMsaaFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, tileMsaaFbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, tileMsaaColor);
+        complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+    
+    if (!complete) {
+        VS_WARN(Render, "Tile atlas framebuffer incomplete, tile caching disabled");
+        setTileCaching(false);
+        return false;
+    }
+    
+    glGenVertexArrays(1, &tileVao);
+    glGenBuffers(1, &tileVbo);
+    glBindVertexArray(tileVao);
+    glBindBuffer(GL_ARRAY_BUFFER, tileVbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex), (void*)offsetof(TileVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(TileVertex), (void*)offsetof(TileVertex, uv));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    for (int slot = tileSlotsPerRow * tileSlotsPerRow - 1; slot >= 0; --slot) {
+        freeTileSlots.push_back(slot);
+    }
+    tileTessellationMode = tessellationMode;
+    tileTessellationTolerance = tessellationTolerance;
+    return true;
+}
+
+void VectorRenderer::releaseTileCache() {
+    if (tileAtlasFbo) glDeleteFramebuffers(1, &tileAtlasFbo);
+    if (tileAtlas) glDeleteTextures(1, &tileAtlas);
+    if (tileMsaaFbo) glDeleteFramebuffers(1, &tileMsaaFbo);
+    if (tileMsaaColor) glDeleteRenderbuffers(1, &tileMsaaColor);
+    if (tileVbo) glDeleteBuffers(1, &tileVbo);
+    if (tileVao) glDeleteVertexArrays(1, &tileVao);
+    tileAtlasFbo = tileAtlas = tileMsaaFbo = tileMsaaColor = tileVbo = tileVao = 0;
+    tileAtlasSize = 0;
+    tileSlotsPerRow = 0;
+    freeTileSlots.clear();
+    tiles.clear();
+}
+
+int VectorRenderer::allocateTileSlot() {
+    if (!freeTileSlots.empty()) {
+        int slot = freeTileSlots.back();
+        freeTileSlots.pop_back();
+        return slot;
+    }
+    
+    // Take the slot of the least recently used tile not shown this frame
+    auto victim = tiles.end();
+    for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+        const Tile& tile = it->second;
+        if (tile.slot >= 0 && tile.lastUsedFrame != tileFrame &&
+            (victim == tiles.end() || tile.lastUsedFrame < victim->second.lastUsedFrame)) {
+            victim = it;
+        }
+    }
+    if (victim == tiles.end()) return -1;
+    
+    int slot = victim->second.slot;
+    tiles.erase(victim);
+    return slot;
+}
+
+void VectorRenderer::renderTile(const TileKey& key, int slot, const StrokePool& strokes,
+                                const std::vector<size_t>& indices) {
+    const int slotX = (slot % tileSlotsPerRow) * TILE_SIZE;
+    const int slotY = (slot / tileSlotsPerRow) * TILE_SIZE;
+    const double tileWorld = std::ldexp(static_cast<double>(TILE_SIZE), -key.level);
+    const glm::vec2 origin(static_cast<float>(key.x * tileWorld), static_cast<float>(key.y * tileWorld));
+    const float pixelsPerUnit = std::ldexp(1.0f, key.level);
+    
+    // A static layer patch leaves its scissor on; renderTiles restores it
+    glDisable(GL_SCISSOR_TEST);
+    if (tileMsaaFbo) {
+        glBindFramebuffer(GL_FRAMEBUFFER, tileMsaaFbo);
+        glViewport(0, 0, TILE_SIZE, TILE_SIZE);
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, tileAtlasFbo);
+        glViewport(slotX, slotY, TILE_SIZE, TILE_SIZE);
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(slotX, slotY, TILE_SIZE, TILE_SIZE);
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glDisable(GL_SCISSOR_TEST);
+    }
+    
+    // Point the regular stroke paths (and their geometry cache) at the tile
+    const glm::mat4 savedProjection = projectionMatrix;
+    const glm::mat4 savedView = viewTransform;
+    const BoundingBox savedBounds = frameBounds;
+    const int savedDetailLevel = frameDetailLevel;
+    const float savedPixelSize = framePixelSize;
+    std::unordered_map<uint64_t, uint32_t> savedDotCells;
+    savedDotCells.swap(frameDotCells);
+    
+    projectionMatrix = glm::ortho(0.0f, static_cast<float>(TILE_SIZE), static_cast<float>(TILE_SIZE), 0.0f, -1.0f, 1.0f);
+    viewTransform = glm::scale(glm::mat4(1.0f), glm::vec3(pixelsPerUnit, pixelsPerUnit, 1.0f)) *
+                    glm::translate(glm::mat4(1.0f), glm::vec3(-origin, 0.0f));
+    frameBounds = BoundingBox(origin, origin + glm::vec2(static_cast<float>(tileWorld)))
+                      .inflated(1.0f / pixelsPerUnit);
+    frameDetailLevel = (tessellationMode == TessellationMode::Adaptive) ? key.level : 0;
+    framePixelSize = 1.0f / pixelsPerUnit;
+    
+    glUseProgram(shaderProgram);
+    for (size_t index : indices) {
+        submitStroke(strokes, index);
+    }
+    flushBatch();
+    
+    projectionMatrix = savedProjection;
+    viewTransform = savedView;
+    frameBounds = savedBounds;
+    frameDetailLevel = savedDetailLevel;
+    framePixelSize = savedPixelSize;
+    frameDotCells.swap(savedDotCells);
+    
+    if (tileMsaaFbo) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, tileMsaaFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, tileAtlasFbo);
+        glBlitFramebuffer(0, 0, TILE_SIZE, TILE_SIZE, slotX, slotY, slotX + TILE_SIZE, slotY + TILE_SIZE,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+}
+
+void VectorRenderer::drawTileQuads() {
+    if (tileVertices.empty()) return;
+    
+    glBindBuffer(GL_ARRAY_BUFFER, tileVbo);
+    glBufferData(GL_ARRAY_BUFFER, tileVertices.size() * sizeof(TileVertex), tileVertices.data(), GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    glm::mat4 mvp = projectionMatrix * viewTransform;
+    
+    // Tiles are opaque (white background included)
+    glDisable(GL_BLEND);
+    glUseProgram(tileProgram);
+    glUniformMatrix4fv(uTileMVP, 1, GL_FALSE, &mvp[0][0]);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, tileAtlas);
+    glUniform1i(uTileAtlas, 0);
+    glBindVertexArray(tileVao);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(tileVertices.size()));
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glEnable(GL_BLEND);
+    glUseProgram(shaderProgram);
+}
+
 void VectorRenderer::endFrame() {
     glUseProgram(0);
+    redrawNeeded = false;
+    
+    // Frames that reuse the static layer draw no cached geometry; counting
+    // them would evict the geometry of strokes that are still on screen
+    if (staticLayerReused) {
+        return;
+    }
+    if (++frameIndex % GEOMETRY_EVICT_INTERVAL == 0) {
+        evictStaleGeometry();
+    }
 }
 
 void VectorRenderer::resize(int width, int height) {
@@ -189,10 +1604,12 @@ void VectorRenderer::resize(int width, int height) {
     windowHeight = height;
     glViewport(0, 0, width, height);
     updateProjection();
+    redrawNeeded = true;
 }
 
 void VectorRenderer::setViewTransform(const glm::mat4& transform) {
     viewTransform = transform;
+    redrawNeeded = true;
 }
 
 void VectorRenderer::pan(const glm::vec2& delta) {
@@ -204,6 +1621,7 @@ void VectorRenderer::pan(const glm::vec2& delta) {
     glm::vec2 scaledDelta = delta / scaleX;
     
     viewTransform = glm::translate(viewTransform, glm::vec3(scaledDelta, 0.0f));
+    redrawNeeded = true;
 }
 
 void VectorRenderer::zoom(float factor, const glm::vec2& center) {
@@ -231,10 +1649,12 @@ void VectorRenderer::zoom(float factor, const glm::vec2& center) {
     viewTransform = glm::mat4(1.0f);
     viewTransform = glm::translate(viewTransform, glm::vec3(newTranslation2D, 0.0f));
     viewTransform = glm::scale(viewTransform, glm::vec3(newScale, newScale, 1.0f));
+    redrawNeeded = true;
 }
 
 void VectorRenderer::resetView() {
     viewTransform = glm::mat4(1.0f);
+    redrawNeeded = true;
 }
 
 glm::vec2 VectorRenderer::screenToWorld(const glm::vec2& screenPos) const {
@@ -248,4 +1668,23 @@ glm::vec2 VectorRenderer::screenToWorld(const glm::vec2& screenPos) const {
     return glm::vec2(worldPos.x, worldPos.y);
 }
 
+BoundingBox VectorRenderer::getVisibleBounds() const {
+    // Map the four window corners back into world space; the box around them
+    // is the visible area (exact for pan/zoom, conservative otherwise)
+    glm::mat4 invView = glm::inverse(viewTransform);
+    glm::vec2 corners[4] = {
+        glm::vec2(0.0f, 0.0f),
+        glm::vec2(static_cast<float>(windowWidth), 0.0f),
+        glm::vec2(0.0f, static_cast<float>(windowHeight)),
+        glm::vec2(static_cast<float>(windowWidth), static_cast<float>(windowHeight))
+    };
+    
+    BoundingBox bounds;
+    for (const auto& corner : corners) {
+        glm::vec4 world = invView * glm::vec4(corner.x, corner.y, 0.0f, 1.0f);
+        bounds.expand(glm::vec2(world.x, world.y));
+    }
+    return bounds;
+}
+
 } // namespace VectorSketch
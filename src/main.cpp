@@ -2,12 +2,17 @@
 #include "VectorRenderer.h"
 #include "StrokePoint.h"
 #include "ToolWheel.h"
+#include "SpscQueue.h"
 #include <GLFW/glfw3.h>
 #include <iostream>
-#include <chrono>
+#include <atomic>
+#include <cfloat>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include "imgui.h"
-#include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 
 using namespace VectorSketch;
@@ -19,6 +24,7 @@ ToolWheel toolWheel;
 bool isDrawing = false;
 glm::vec2 lastMousePos(0.0f);         // Screen space
 glm::vec2 lastWorldPos(0.0f);        // World space
+double lastSampleTime = 0.0;         // Arrival time of lastWorldPos
 glm::vec2 panStart(0.0f);
 bool isPanning = false;
 
@@ -32,12 +38,88 @@ bool isDrawingLasso = false;
 bool isMovingSelection = false;
 glm::vec2 moveStartPos(0.0f);
 
-auto startTime = std::chrono::high_resolution_clock::now();
+// Finished strokes are stored as fitted curves (tool's fitTolerance)
+bool fitCurves = true;
 
-float getCurrentTime() {
-    auto now = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime);
-    return duration.count() / 1000.0f;
+// Redraw scheduling: frames are only drawn after input or when the canvas or
+// the view changed. ImGui settles hover and active states one frame after the
+// event that caused them, so each event asks for two frames.
+const int UI_FRAMES_PER_EVENT = 2;
+const double IDLE_WAIT_SECONDS = 0.5;  // Upper bound on sleeping without events
+int pendingUiFrames = UI_FRAMES_PER_EVENT;
+
+void requestRedraw() {
+    pendingUiFrames = UI_FRAMES_PER_EVENT;
+}
+
+bool needsRedraw() {
+    return pendingUiFrames > 0 || canvas.needsRedraw() || renderer.needsRedraw();
+}
+
+// Input capture and rendering run on separate threads. The main thread only
+// waits for GLFW events (which must be handled there) and queues each one
+// with the time it arrived; the render thread owns the GL context, ImGui and
+// the canvas and drains the queue in one batch per frame. A slow frame
+// delays samples but no longer merges or re-times them.
+enum class InputEventType : uint8_t {
+    MouseButton,
+    CursorPos,
+    Scroll,
+    Key,
+    Char,
+    WindowSize,
+    FramebufferSize,
+    Focus,
+    CursorEnter,
+    Refresh
+};
+
+struct InputEvent {
+    InputEventType type = InputEventType::Refresh;
+    double time = 0.0;        // glfwGetTime() when the event arrived
+    double x = 0.0;           // Cursor position, or new size
+    double y = 0.0;
+    double scrollX = 0.0;
+    double scrollY = 0.0;
+    int button = 0;
+    int key = 0;
+    int scancode = 0;
+    int action = 0;           // Also focused / entered
+    int mods = 0;
+    unsigned int codepoint = 0;
+};
+
+// About 8 s of 1 kHz pointer samples while the render thread is stalled
+const size_t INPUT_QUEUE_CAPACITY = 8192;
+SpscQueue<InputEvent> inputQueue(INPUT_QUEUE_CAPACITY);
+std::atomic<uint64_t> droppedInputEvents{0};
+
+// Lets the render thread sleep while idle; the queue itself takes no lock
+std::mutex wakeMutex;
+std::condition_variable wakeCondition;
+bool wakeRequested = false;
+
+void wakeRenderThread() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        wakeRequested = true;
+    }
+    wakeCondition.notify_one();
+}
+
+void waitForWakeUp(double seconds) {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    wakeCondition.wait_for(lock, std::chrono::duration<double>(seconds), [] { return wakeRequested; });
+    wakeRequested = false;
+}
+
+// Main thread
+void queueInput(InputEvent event) {
+    event.time = glfwGetTime();
+    if (!inputQueue.push(event)) {
+        droppedInputEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeRenderThread();
 }
 
 // Open native file dialog using zenity (Ubuntu/GNOME)
@@ -141,10 +223,13 @@ float simulatePressure(const glm::vec2& currentPos, const glm::vec2& lastPos, fl
     return glm::clamp(pressure, 0.3f, 1.0f);
 }
 
-void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
-    double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
-    glm::vec2 mousePos(static_cast<float>(xpos), static_cast<float>(ypos));
+// Input handlers, called on the render thread for each queued event
+
+void handleMouseButton(const InputEvent& event) {
+    requestRedraw();
+    const int button = event.button;
+    const int action = event.action;
+    glm::vec2 mousePos(static_cast<float>(event.x), static_cast<float>(event.y));
     
     if (button == GLFW_MOUSE_BUTTON_LEFT) {
         if (action == GLFW_PRESS && !isPanning && !toolWheel.isMouseOverUI()) {
@@ -174,15 +259,20 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
                 // Start new stroke with current tool settings
                 glm::vec3 color = toolWheel.getEffectiveColor();
                 float brushWidth = toolWheel.getBrushWidth();
+                StrokeInputFilter filter = toolWheel.getInputFilter(currentTool).scaled(1.0f / renderer.getViewScale());
+                if (!fitCurves) {
+                    filter.fitTolerance = 0.0f;
+                }
                 
-                canvas.beginStroke(color, brushWidth);
+                canvas.beginStroke(color, brushWidth, filter);
                 
                 // Convert screen to world coordinates
                 glm::vec2 worldPos = renderer.screenToWorld(mousePos);
-                StrokePoint point(worldPos, 1.0f, 0.0f, 0.0f, getCurrentTime());
+                StrokePoint point(worldPos, 1.0f, 0.0f, 0.0f, static_cast<float>(event.time));
                 canvas.addPointToCurrentStroke(point);
                 lastMousePos = mousePos;
                 lastWorldPos = worldPos;
+                lastSampleTime = event.time;
             }
         } else if (action == GLFW_RELEASE) {
             if (isDrawing) {
@@ -199,6 +289,7 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
                 lassoPoints.clear();
             } else if (isMovingSelection) {
                 // Finish moving selection
+                canvas.finishMovingSelection();
                 isMovingSelection = false;
                 std::cout << "Finished moving selection" << std::endl;
             }
@@ -219,14 +310,16 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     }
 }
 
-void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
-    glm::vec2 mousePos(static_cast<float>(xpos), static_cast<float>(ypos));
+void handleCursorPos(const InputEvent& event) {
+    requestRedraw();
+    glm::vec2 mousePos(static_cast<float>(event.x), static_cast<float>(event.y));
     
     if (isDrawing && !isPanning) {
-        // Normal drawing (Brush/Eraser)
+        // Normal drawing (Brush/Eraser), timed by when the samples arrived
+        // rather than when this frame got to them
         glm::vec2 worldPos = renderer.screenToWorld(mousePos);
         
-        float deltaTime = 0.016f;
+        float deltaTime = static_cast<float>(event.time - lastSampleTime);
         float pressure = simulatePressure(worldPos, lastWorldPos, deltaTime);
         
         glm::vec2 direction = worldPos - lastWorldPos;
@@ -239,9 +332,10 @@ void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
             tiltY = direction.y * 0.3f;
         }
         
-        StrokePoint point(worldPos, pressure, tiltX, tiltY, getCurrentTime());
+        StrokePoint point(worldPos, pressure, tiltX, tiltY, static_cast<float>(event.time));
         canvas.addPointToCurrentStroke(point);
         lastWorldPos = worldPos;
+        lastSampleTime = event.time;
     } else if (isDrawingLasso) {
         // Add points to lasso path
         if (glm::distance(mousePos, lassoPoints.back()) > 3.0f) { // Sample every 3 pixels
@@ -265,17 +359,19 @@ void cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
     lastMousePos = mousePos;
 }
 
-void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-    double xpos, ypos;
-    glfwGetCursorPos(window, &xpos, &ypos);
-    glm::vec2 mousePos(static_cast<float>(xpos), static_cast<float>(ypos));
+void handleScroll(const InputEvent& event) {
+    requestRedraw();
+    glm::vec2 mousePos(static_cast<float>(event.x), static_cast<float>(event.y));
     
-    float zoomFactor = 1.0f + static_cast<float>(yoffset) * 0.1f;
+    float zoomFactor = 1.0f + static_cast<float>(event.scrollY) * 0.1f;
     renderer.zoom(zoomFactor, mousePos);
 }
 
-void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
-    if (action == GLFW_PRESS) {
+void handleKey(GLFWwindow* window, const InputEvent& event) {
+    requestRedraw();
+    const int key = event.key;
+    const int mods = event.mods;
+    if (event.action == GLFW_PRESS) {
         // Check for Ctrl modifier
         bool ctrlPressed = (mods & GLFW_MOD_CONTROL) != 0;
         bool shiftPressed = (mods & GLFW_MOD_SHIFT) != 0;
@@ -308,111 +404,301 @@ void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods
             // Reset view
             renderer.resetView();
             std::cout << "View reset" << std::endl;
+        } else if (key == GLFW_KEY_B) {
+            // Toggle batched stroke rendering
+            bool batched = renderer.getRenderMode() == RenderMode::Batched;
+            renderer.setRenderMode(batched ? RenderMode::PerStroke : RenderMode::Batched);
+            std::cout << "Batched rendering " << (batched ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_G) {
+            // Toggle GPU stroke expansion (vertex shader builds the strips)
+            bool expanded = renderer.getRenderMode() == RenderMode::GpuExpanded;
+            renderer.setRenderMode(expanded ? RenderMode::Batched : RenderMode::GpuExpanded);
+            std::cout << "GPU stroke expansion " << (expanded ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_T) {
+            // Toggle zoom-aware tessellation
+            bool adaptive = renderer.getTessellationMode() == TessellationMode::Adaptive;
+            renderer.setTessellationMode(adaptive ? TessellationMode::Fixed : TessellationMode::Adaptive);
+            std::cout << "Adaptive tessellation " << (adaptive ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_L) {
+            // Toggle the cached static layer under the live stroke
+            bool composited = renderer.isCompositing();
+            renderer.setCompositing(!composited);
+            std::cout << "Static layer cache " << (composited ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_P) {
+            // Toggle the tile pyramid used while panning and zooming
+            bool tiled = renderer.isTileCaching();
+            renderer.setTileCaching(!tiled);
+            std::cout << "Tile cache " << (tiled ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_D) {
+            // Toggle simplified strokes when zoomed out
+            bool simplified = renderer.isSimplifyingStrokes();
+            renderer.setStrokeSimplification(!simplified);
+            std::cout << "Stroke simplification " << (simplified ? "off" : "on") << std::endl;
+        } else if (key == GLFW_KEY_F) {
+            // Toggle curve fitting for strokes drawn from now on
+            fitCurves = !fitCurves;
+            std::cout << "Curve fitting " << (fitCurves ? "on" : "off") << std::endl;
         } else if (key == GLFW_KEY_ESCAPE) {
             // ESC: Clear selection or exit
             if (canvas.hasSelection()) {
                 canvas.clearSelection();
                 std::cout << "Selection cleared" << std::endl;
             } else {
+                // Wake the main thread, which waits for events
                 glfwSetWindowShouldClose(window, GLFW_TRUE);
+                glfwPostEmptyEvent();
             }
         }
     }
 }
 
-void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
-    renderer.resize(width, height);
+// GLFW keys the tool wheel's widgets use (text fields, sliders, navigation)
+ImGuiKey toImGuiKey(int key) {
+    if (key >= GLFW_KEY_A && key <= GLFW_KEY_Z) return static_cast<ImGuiKey>(ImGuiKey_A + (key - GLFW_KEY_A));
+    if (key >= GLFW_KEY_0 && key <= GLFW_KEY_9) return static_cast<ImGuiKey>(ImGuiKey_0 + (key - GLFW_KEY_0));
+    switch (key) {
+        case GLFW_KEY_TAB: return ImGuiKey_Tab;
+        case GLFW_KEY_LEFT: return ImGuiKey_LeftArrow;
+        case GLFW_KEY_RIGHT: return ImGuiKey_RightArrow;
+        case GLFW_KEY_UP: return ImGuiKey_UpArrow;
+        case GLFW_KEY_DOWN: return ImGuiKey_DownArrow;
+        case GLFW_KEY_PAGE_UP: return ImGuiKey_PageUp;
+        case GLFW_KEY_PAGE_DOWN: return ImGuiKey_PageDown;
+        case GLFW_KEY_HOME: return ImGuiKey_Home;
+        case GLFW_KEY_END: return ImGuiKey_End;
+        case GLFW_KEY_INSERT: return ImGuiKey_Insert;
+        case GLFW_KEY_DELETE: return ImGuiKey_Delete;
+        case GLFW_KEY_BACKSPACE: return ImGuiKey_Backspace;
+        case GLFW_KEY_SPACE: return ImGuiKey_Space;
+        case GLFW_KEY_ENTER: return ImGuiKey_Enter;
+        case GLFW_KEY_KP_ENTER: return ImGuiKey_KeypadEnter;
+        case GLFW_KEY_ESCAPE: return ImGuiKey_Escape;
+        case GLFW_KEY_MINUS: return ImGuiKey_Minus;
+        case GLFW_KEY_PERIOD: return ImGuiKey_Period;
+        case GLFW_KEY_LEFT_CONTROL: return ImGuiKey_LeftCtrl;
+        case GLFW_KEY_RIGHT_CONTROL: return ImGuiKey_RightCtrl;
+        case GLFW_KEY_LEFT_SHIFT: return ImGuiKey_LeftShift;
+        case GLFW_KEY_RIGHT_SHIFT: return ImGuiKey_RightShift;
+        case GLFW_KEY_LEFT_ALT: return ImGuiKey_LeftAlt;
+        case GLFW_KEY_RIGHT_ALT: return ImGuiKey_RightAlt;
+        case GLFW_KEY_LEFT_SUPER: return ImGuiKey_LeftSuper;
+        case GLFW_KEY_RIGHT_SUPER: return ImGuiKey_RightSuper;
+        default: return ImGuiKey_None;
+    }
 }
 
-int main() {
-    // Initialize GLFW
-    if (!glfwInit()) {
-        std::cerr << "Failed to initialize GLFW" << std::endl;
-        return -1;
-    }
-    
-    // Configure GLFW
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    glfwWindowHint(GLFW_SAMPLES, 4); // 4x MSAA
-    
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
+// Feed a queued event to ImGui. The GLFW backend can't do this here: it
+// installs callbacks and queries the window, which only the main thread may do.
+void forwardToImGui(const InputEvent& event) {
+    ImGuiIO& io = ImGui::GetIO();
+    auto updateModifiers = [&io](int mods) {
+        io.AddKeyEvent(ImGuiMod_Ctrl, (mods & GLFW_MOD_CONTROL) != 0);
+        io.AddKeyEvent(ImGuiMod_Shift, (mods & GLFW_MOD_SHIFT) != 0);
+        io.AddKeyEvent(ImGuiMod_Alt, (mods & GLFW_MOD_ALT) != 0);
+        io.AddKeyEvent(ImGuiMod_Super, (mods & GLFW_MOD_SUPER) != 0);
+    };
     
-    // Create window
-    GLFWwindow* window = glfwCreateWindow(1280, 720, "Vector Sketch - Infinite Canvas", nullptr, nullptr);
-    if (!window) {
-        std::cerr << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
+    switch (event.type) {
+        case InputEventType::MouseButton:
+            updateModifiers(event.mods);
+            if (event.button >= 0 && event.button < ImGuiMouseButton_COUNT) {
+                io.AddMouseButtonEvent(event.button, event.action == GLFW_PRESS);
+            }
+            break;
+        case InputEventType::CursorPos:
+            io.AddMousePosEvent(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case InputEventType::Scroll:
+            io.AddMouseWheelEvent(static_cast<float>(event.scrollX), static_cast<float>(event.scrollY));
+            break;
+        case InputEventType::Key:
+            if (event.action == GLFW_PRESS || event.action == GLFW_RELEASE) {
+                updateModifiers(event.mods);
+                io.AddKeyEvent(toImGuiKey(event.key), event.action == GLFW_PRESS);
+            }
+            break;
+        case InputEventType::Char:
+            io.AddInputCharacter(event.codepoint);
+            break;
+        case InputEventType::WindowSize:
+            io.DisplaySize = ImVec2(static_cast<float>(event.x), static_cast<float>(event.y));
+            break;
+        case InputEventType::Focus:
+            io.AddFocusEvent(event.action != 0);
+            break;
+        case InputEventType::CursorEnter:
+            if (!event.action) io.AddMousePosEvent(-FLT_MAX, -FLT_MAX);
+            break;
+        case InputEventType::FramebufferSize:
+        case InputEventType::Refresh:
+            break;
     }
+}
+
+// Render thread: apply everything that arrived since the last frame, in order
+void processInput(GLFWwindow* window, int& framebufferWidth, int& framebufferHeight) {
+    inputQueue.drain([&](const InputEvent& event) {
+        forwardToImGui(event);
+        switch (event.type) {
+            case InputEventType::MouseButton: handleMouseButton(event); break;
+            case InputEventType::CursorPos: handleCursorPos(event); break;
+            case InputEventType::Scroll: handleScroll(event); break;
+            case InputEventType::Key: handleKey(window, event); break;
+            case InputEventType::FramebufferSize:
+                framebufferWidth = static_cast<int>(event.x);
+                framebufferHeight = static_cast<int>(event.y);
+                renderer.resize(framebufferWidth, framebufferHeight);
+                requestRedraw();
+                break;
+            default:
+                // Events that change nothing but the UI (text input, focus, hover, exposure)
+                requestRedraw();
+                break;
+        }
+    });
     
+    static uint64_t reportedDrops = 0;
+    uint64_t drops = droppedInputEvents.load(std::memory_order_relaxed);
+    if (drops != reportedDrops) {
+        std::cerr << "Input queue full, " << (drops - reportedDrops) << " event(s) dropped" << std::endl;
+        reportedDrops = drops;
+    }
+}
+
+// GLFW callbacks, on the main thread: record and queue, nothing else
+
+void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    InputEvent event;
+    event.type = InputEventType::MouseButton;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    event.button = button;
+    event.action = action;
+    event.mods = mods;
+    queueInput(event);
+}
+
+void cursorPosCallback(GLFWwindow*, double xpos, double ypos) {
+    InputEvent event;
+    event.type = InputEventType::CursorPos;
+    event.x = xpos;
+    event.y = ypos;
+    queueInput(event);
+}
+
+void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+    InputEvent event;
+    event.type = InputEventType::Scroll;
+    glfwGetCursorPos(window, &event.x, &event.y);
+    event.scrollX = xoffset;
+    event.scrollY = yoffset;
+    queueInput(event);
+}
+
+void keyCallback(GLFWwindow*, int key, int scancode, int action, int mods) {
+    InputEvent event;
+    event.type = InputEventType::Key;
+    event.key = key;
+    event.scancode = scancode;
+    event.action = action;
+    event.mods = mods;
+    queueInput(event);
+}
+
+void charCallback(GLFWwindow*, unsigned int codepoint) {
+    InputEvent event;
+    event.type = InputEventType::Char;
+    event.codepoint = codepoint;
+    queueInput(event);
+}
+
+void windowSizeCallback(GLFWwindow*, int width, int height) {
+    InputEvent event;
+    event.type = InputEventType::WindowSize;
+    event.x = width;
+    event.y = height;
+    queueInput(event);
+}
+
+void framebufferSizeCallback(GLFWwindow*, int width, int height) {
+    InputEvent event;
+    event.type = InputEventType::FramebufferSize;
+    event.x = width;
+    event.y = height;
+    queueInput(event);
+}
+
+void windowFocusCallback(GLFWwindow*, int focused) {
+    InputEvent event;
+    event.type = InputEventType::Focus;
+    event.action = focused;
+    queueInput(event);
+}
+
+void cursorEnterCallback(GLFWwindow*, int entered) {
+    InputEvent event;
+    event.type = InputEventType::CursorEnter;
+    event.action = entered;
+    queueInput(event);
+}
+
+void windowRefreshCallback(GLFWwindow*) {
+    InputEvent event;
+    event.type = InputEventType::Refresh;
+    queueInput(event);
+}
+
+// Render thread: owns the GL context, ImGui and the canvas from start to exit
+std::atomic<bool> renderThreadFailed{false};
+
+void renderThreadMain(GLFWwindow* window, Antialiasing antialiasing, int windowWidth, int windowHeight,
+                      int display_w, int display_h) {
     glfwMakeContextCurrent(window);
     glfwSwapInterval(1); // Enable vsync
     
-    // Set callbacks
-    glfwSetMouseButtonCallback(window, mouseButtonCallback);
-    glfwSetCursorPosCallback(window, cursorPosCallback);
-    glfwSetScrollCallback(window, scrollCallback);
-    glfwSetKeyCallback(window, keyCallback);
-    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
-    
     // Initialize renderer
-    if (!renderer.initialize(1280, 720)) {
+    if (!renderer.initialize(display_w, display_h, antialiasing)) {
         std::cerr << "Failed to initialize renderer" << std::endl;
-        glfwTerminate();
-        return -1;
+        renderThreadFailed = true;
+        glfwSetWindowShouldClose(window, GLFW_TRUE);
+        glfwPostEmptyEvent();
+        glfwMakeContextCurrent(nullptr);
+        return;
     }
     
-    // Initialize ImGui
+    // Initialize ImGui; its input comes from the queue (see forwardToImGui)
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
+    ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+    io.BackendPlatformName = "vectorsketch_input_queue";
+    io.DisplaySize = ImVec2(static_cast<float>(windowWidth), static_cast<float>(windowHeight));
     
     // Setup ImGui style
     ImGui::StyleColorsDark();
     
-    // Setup Platform/Renderer backends
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
+    // Setup Renderer backend
     ImGui_ImplOpenGL3_Init("#version 330");
     
-    std::cout << "=== Vector Sketch POC ===" << std::endl;
-    std::cout << "Controls:" << std::endl;
-    std::cout << "  Left Mouse: Draw strokes" << std::endl;
-    std::cout << "  Middle/Right Mouse: Pan canvas" << std::endl;
-    std::cout << "  Scroll: Zoom in/out" << std::endl;
-    std::cout << "  Ctrl+S: Save to .mm file" << std::endl;
-    std::cout << "  Ctrl+O: Open .mm file" << std::endl;
-    std::cout << "  Ctrl+Z: Undo (up to 7 actions)" << std::endl;
-    std::cout << "  Ctrl+Shift+Z: Redo" << std::endl;
-    std::cout << "  C: Clear canvas" << std::endl;
-    std::cout << "  R: Reset view" << std::endl;
-    std::cout << "  ESC: Exit" << std::endl;
-    std::cout << std::endl;
-    std::cout << "Features:" << std::endl;
-    std::cout << "  ✓ Stroke sampling with pressure/tilt simulation" << std::endl;
-    std::cout << "  ✓ Bézier curve smoothing" << std::endl;
-    std::cout << "  ✓ GPU-accelerated rendering (OpenGL)" << std::endl;
-    std::cout << "  ✓ Infinite canvas with pan/zoom" << std::endl;
-    std::cout << std::endl;
-    
-    // Main loop
+    double lastFrameTime = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
-        // Poll events
-        glfwPollEvents();
+        // Sleep until input arrives while nothing is out of date, instead
+        // of redrawing every vsync
+        if (!needsRedraw()) {
+            waitForWakeUp(IDLE_WAIT_SECONDS);
+        }
+        processInput(window, display_w, display_h);
+        if (!needsRedraw()) continue;
         
         // Start ImGui frame
+        double now = glfwGetTime();
+        io.DeltaTime = static_cast<float>(std::max(now - lastFrameTime, 1e-4));
+        lastFrameTime = now;
+        if (io.DisplaySize.x > 0.0f && io.DisplaySize.y > 0.0f) {
+            io.DisplayFramebufferScale = ImVec2(display_w / io.DisplaySize.x, display_h / io.DisplaySize.y);
+        }
         ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         
-        // Get window size for UI
-        int display_w, display_h;
-        glfwGetFramebufferSize(window, &display_w, &display_h);
-        
         // Render canvas
         renderer.beginFrame();
         canvas.render(renderer);
@@ -466,14 +752,103 @@ int main() {
         
         // Swap buffers
         glfwSwapBuffers(window);
+        if (pendingUiFrames > 0) --pendingUiFrames;
     }
     
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
+    glfwMakeContextCurrent(nullptr);
+}
+
+int main(int argc, char** argv) {
+    // --analytic-aa: single-sample window, edges antialiased in the shader
+    Antialiasing antialiasing = Antialiasing::Multisample;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--analytic-aa") == 0) {
+            antialiasing = Antialiasing::Analytic;
+        }
+    }
+    
+    // Initialize GLFW
+    if (!glfwInit()) {
+        std::cerr << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
+    
+    // Configure GLFW
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_SAMPLES, (antialiasing == Antialiasing::Multisample) ? 4 : 0); // 4x MSAA
+    
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+    
+    // Create window
+    GLFWwindow* window = glfwCreateWindow(1280, 720, "Vector Sketch - Infinite Canvas", nullptr, nullptr);
+    if (!window) {
+        std::cerr << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    
+    // Set callbacks
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+    glfwSetScrollCallback(window, scrollCallback);
+    glfwSetKeyCallback(window, keyCallback);
+    glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+    glfwSetWindowSizeCallback(window, windowSizeCallback);
+    glfwSetCharCallback(window, charCallback);
+    glfwSetWindowFocusCallback(window, windowFocusCallback);
+    glfwSetCursorEnterCallback(window, cursorEnterCallback);
+    glfwSetWindowRefreshCallback(window, windowRefreshCallback);
+    
+    std::cout << "=== Vector Sketch POC ===" << std::endl;
+    std::cout << "Controls:" << std::endl;
+    std::cout << "  Left Mouse: Draw strokes" << std::endl;
+    std::cout << "  Middle/Right Mouse: Pan canvas" << std::endl;
+    std::cout << "  Scroll: Zoom in/out" << std::endl;
+    std::cout << "  Ctrl+S: Save to .mm file" << std::endl;
+    std::cout << "  Ctrl+O: Open .mm file" << std::endl;
+    std::cout << "  Ctrl+Z: Undo (history limited by memory, 64 MB)" << std::endl;
+    std::cout << "  Ctrl+Shift+Z: Redo" << std::endl;
+    std::cout << "  C: Clear canvas" << std::endl;
+    std::cout << "  R: Reset view" << std::endl;
+    std::cout << "  B: Toggle batched rendering" << std::endl;
+    std::cout << "  G: Toggle GPU stroke expansion" << std::endl;
+    std::cout << "  T: Toggle adaptive tessellation" << std::endl;
+    std::cout << "  L: Toggle static layer cache" << std::endl;
+    std::cout << "  P: Toggle tile cache" << std::endl;
+    std::cout << "  D: Toggle stroke simplification (level of detail)" << std::endl;
+    std::cout << "  F: Toggle curve fitting of finished strokes" << std::endl;
+    std::cout << "  ESC: Exit" << std::endl;
+    std::cout << "  (start with --analytic-aa for shader antialiasing without MSAA)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Features:" << std::endl;
+    std::cout << "  ✓ Stroke sampling with pressure/tilt simulation" << std::endl;
+    std::cout << "  ✓ Bézier curve smoothing" << std::endl;
+    std::cout << "  ✓ GPU-accelerated rendering (OpenGL)" << std::endl;
+    std::cout << "  ✓ Infinite canvas with pan/zoom" << std::endl;
+    std::cout << std::endl;
+    
+    // Rendering moves to its own thread; this one only waits for events
+    int windowWidth, windowHeight, display_w, display_h;
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+    glfwGetFramebufferSize(window, &display_w, &display_h);
+    std::thread renderThread(renderThreadMain, window, antialiasing, windowWidth, windowHeight, display_w, display_h);
+    
+    // Main loop
+    while (!glfwWindowShouldClose(window)) {
+        glfwWaitEvents();
+    }
+    wakeRenderThread();
+    renderThread.join();
     
     // Cleanup GLFW
+    glfwDestroyWindow(window);
     glfwTerminate();
-    return 0;
+    return renderThreadFailed ? -1 : 0;
 }
@@ -6,6 +6,7 @@
  *   const canvas = require('./build/Release/infinitecanvas.node');
  *   canvas.init();
  *   canvas.openWindow();
+ *   await canvas.saveDrawing('/path/to/file.mm');
  */
 
 #include <napi.h>
@@ -13,10 +14,18 @@
 #include "VectorRenderer.h"
 #include "ToolWheel.h"
 #include "StrokePoint.h"
+#include "MpscQueue.h"
+#include "Log.h"
 #include <GLFW/glfw3.h>
 #include <thread>
-#include <iostream>
 #include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
@@ -30,7 +39,7 @@ using namespace VectorSketch;
 static Canvas* g_canvas = nullptr;
 static VectorRenderer* g_renderer = nullptr;
 static ToolWheel* g_toolWheel = nullptr;
-static GLFWwindow* g_window = nullptr;
+static std::atomic<GLFWwindow*> g_window{nullptr};
 static std::thread* g_renderThread = nullptr;
 
 // Drawing state
@@ -49,6 +58,453 @@ static glm::vec2 moveStartPos(0.0f);
 // Timing
 static auto startTime = std::chrono::high_resolution_clock::now();
 
+// ============================================================================
+// Canvas Commands
+// ============================================================================
+//
+// The canvas belongs to one thread at a time: the render thread while its
+// loop runs, the JS thread otherwise; g_canvasOwner is held by the owner.
+// JS functions never touch the canvas directly. They queue a command,
+// return a promise, and the owner runs queued commands between frames.
+// Results come back to the JS thread through g_settleCommands. Reads work
+// on a snapshot (a StrokePool copy sharing the committed strokes' arrays; the
+// canvas copies them only if it edits while the snapshot is alive), so file
+// writes happen off the canvas while the render thread keeps drawing.
+
+enum class CommandType {
+    Clear,
+    ReplaceStrokes,  // Swap in strokes read from a file (undoable)
+    AddStrokes,      // Append strokes built from JS arrays (one undo step)
+    Snapshot         // Share the committed strokes as they are now
+};
+
+// Settles a command's promise on the JS thread once the owner ran it
+struct CommandResult {
+    using Settle = std::function<void(Napi::Env, CommandResult&)>;
+    
+    CommandResult(Napi::Env env, Settle settle)
+        : deferred(Napi::Promise::Deferred::New(env)), settle(std::move(settle)) {}
+    
+    Napi::Promise::Deferred deferred;
+    Settle settle;  // Resolves or rejects deferred, or hands it on
+    bool success = false;
+    std::shared_ptr<const StrokePool> snapshot;  // Snapshot commands
+};
+
+struct CanvasCommand {
+    CommandType type = CommandType::Clear;
+    StrokePool strokes;  // ReplaceStrokes, AddStrokes: the strokes to swap in or append
+    CommandResult* result = nullptr;
+};
+
+static constexpr size_t COMMAND_QUEUE_CAPACITY = 256;
+static constexpr float DEFAULT_IMPORT_WIDTH = 2.0f;  // addStrokes without widths
+static constexpr float MAX_IMPORT_COORDINATE = 1e9f; // addStrokes x, y and widths, in world units
+static MpscQueue<CanvasCommand> g_commands(COMMAND_QUEUE_CAPACITY);
+static std::mutex g_canvasOwner;
+static std::atomic<bool> g_renderLoopRunning{false};
+static Napi::ThreadSafeFunction g_settleCommands;
+static size_t g_unsettledCommands = 0;  // JS thread only
+
+// Latest snapshot while anything still holds it; owner thread only. Not
+// kept alive here: a live snapshot makes the canvas's next edit copy the
+// arrays it shares with it (see StrokePool)
+static std::weak_ptr<const StrokePool> g_snapshot;
+
+static void executeCommand(CanvasCommand& command) {
+    CommandResult* result = command.result;
+    switch (command.type) {
+        case CommandType::Clear:
+            g_canvas->clear();
+            break;
+        case CommandType::ReplaceStrokes:
+            g_canvas->replaceStrokes(command.strokes);
+            break;
+        case CommandType::AddStrokes:
+            g_canvas->addStrokes(command.strokes);
+            break;
+        case CommandType::Snapshot: {
+            // A copy shares the pool's arrays, so this costs no stroke data;
+            // strokes unchanged since the last snapshot reuse it
+            const StrokePool& strokes = g_canvas->getStrokes();
+            result->snapshot = g_snapshot.lock();
+            if (!result->snapshot || result->snapshot->getVersion() != strokes.getVersion()) {
+                result->snapshot = std::make_shared<const StrokePool>(strokes);
+                g_snapshot = result->snapshot;
+            }
+            break;
+        }
+    }
+    result->success = true;
+    command.result = nullptr;
+    
+    g_settleCommands.NonBlockingCall(result, [](Napi::Env env, Napi::Function, CommandResult* result) {
+        result->settle(env, *result);
+        delete result;
+        if (--g_unsettledCommands == 0) {
+            g_settleCommands.Unref(env);
+        }
+    });
+}
+
+// Caller holds g_canvasOwner
+static void drainCommands() {
+    g_commands.drain([](CanvasCommand& command) { executeCommand(command); });
+}
+
+static Napi::Value resolvedPromise(Napi::Env env, Napi::Value value) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    deferred.Resolve(value);
+    return deferred.Promise();
+}
+
+// Queue a command and return its promise, settled by `settle` once the
+// command ran
+static Napi::Value submitCommand(Napi::Env env, CanvasCommand command, CommandResult::Settle settle) {
+    CommandResult* result = new CommandResult(env, std::move(settle));
+    Napi::Promise promise = result->deferred.Promise();
+    
+    command.result = result;
+    if (!g_commands.push(std::move(command))) {
+        result->deferred.Reject(Napi::Error::New(env, "Canvas command queue is full").Value());
+        delete result;
+        return promise;
+    }
+    
+    // Keep Node alive until the promise is settled
+    if (g_unsettledCommands++ == 0) {
+        g_settleCommands.Ref(env);
+    }
+    
+    // While the render loop runs it picks the command up before its next
+    // frame. Otherwise the canvas is ours; the owner lock is only contended
+    // for the moment the render thread takes or gives back the canvas.
+    while (!g_renderLoopRunning.load()) {
+        if (g_canvasOwner.try_lock()) {
+            drainCommands();
+            g_canvasOwner.unlock();
+            break;
+        }
+        std::this_thread::yield();
+    }
+    return promise;
+}
+
+// ============================================================================
+// File Workers
+// ============================================================================
+//
+// Async saves and loads do their file I/O on a libuv worker thread. A save
+// writes an immutable snapshot, so the canvas keeps changing meanwhile; a
+// load reads into its own pool and queues the swap, which the canvas owner
+// applies at its next frame boundary.
+
+// Settles a promise with the result of file I/O done off the JS thread,
+// forwarding progress to an optional JS callback
+class FileWorker : public Napi::AsyncWorker {
+protected:
+    FileWorker(Napi::Env env, const Napi::Promise::Deferred& deferred, const std::string& filepath,
+               const Napi::Value& onProgress)
+        : Napi::AsyncWorker(env, "CanvasFileWorker"), deferred(deferred), filepath(filepath) {
+        if (onProgress.IsFunction()) {
+            progress = Napi::ThreadSafeFunction::New(env, onProgress.As<Napi::Function>(), "CanvasFileProgress", 0, 1);
+            hasProgress = true;
+        }
+    }
+    
+    ~FileWorker() override {
+        if (hasProgress) {
+            progress.Release();
+        }
+    }
+    
+    // Called on the worker thread; calls onProgress(fraction) on the JS thread
+    Canvas::FileProgress progressCallback() {
+        if (!hasProgress) return nullptr;
+        return [this](float fraction) {
+            progress.NonBlockingCall([fraction](Napi::Env env, Napi::Function callback) {
+                callback.Call({Napi::Number::New(env, fraction)});
+            });
+        };
+    }
+    
+    Napi::Promise::Deferred deferred;
+    std::string filepath;
+    bool success = false;
+    
+private:
+    Napi::ThreadSafeFunction progress;
+    bool hasProgress = false;
+};
+
+class SaveWorker : public FileWorker {
+public:
+    SaveWorker(Napi::Env env, const Napi::Promise::Deferred& deferred, const std::string& filepath,
+               const Napi::Value& onProgress, std::shared_ptr<const StrokePool> snapshot)
+        : FileWorker(env, deferred, filepath, onProgress), snapshot(std::move(snapshot)) {}
+    
+    void Execute() override {
+        success = Canvas::writeStrokes(*snapshot, filepath, progressCallback());
+    }
+    
+    void OnOK() override {
+        if (success) {
+            VS_INFO(Addon, "✓ Saved: " << filepath);
+        } else {
+            VS_ERROR(Addon, "✗ Failed to save: " << filepath);
+        }
+        deferred.Resolve(Napi::Boolean::New(Env(), success));
+    }
+    
+private:
+    std::shared_ptr<const StrokePool> snapshot;
+};
+
+class LoadWorker : public FileWorker {
+public:
+    LoadWorker(Napi::Env env, const Napi::Promise::Deferred& deferred, const std::string& filepath,
+               const Napi::Value& onProgress)
+        : FileWorker(env, deferred, filepath, onProgress) {}
+    
+    void Execute() override {
+        success = Canvas::readStrokes(filepath, strokes, progressCallback());
+    }
+    
+    void OnOK() override {
+        Napi::Env env = Env();
+        if (!success) {
+            VS_ERROR(Addon, "✗ Failed to load: " << filepath);
+            deferred.Resolve(Napi::Boolean::New(env, false));
+            return;
+        }
+        
+        // The promise follows the swap's
+        CanvasCommand command;
+        command.type = CommandType::ReplaceStrokes;
+        command.strokes = std::move(strokes);
+        std::string path = filepath;
+        deferred.Resolve(submitCommand(env, std::move(command), [path](Napi::Env env, CommandResult& result) {
+            VS_INFO(Addon, "✓ Loaded: " << path);
+            result.deferred.Resolve(Napi::Boolean::New(env, result.success));
+        }));
+    }
+    
+private:
+    StrokePool strokes;
+};
+
+// ============================================================================
+// Bulk Stroke Import
+// ============================================================================
+
+// Arguments of addStrokes, copied off the JS arrays (see StrokePool::appendPacked)
+struct PackedStrokes {
+    std::vector<float> points;
+    size_t stride = 0;
+    std::vector<uint32_t> offsets;
+    std::vector<float> colors;
+    std::vector<float> widths;
+};
+
+// Builds the strokes (bounds, levels of detail) off the JS thread, then
+// queues them for the canvas owner; the promise follows the append's
+class AddStrokesWorker : public Napi::AsyncWorker {
+public:
+    AddStrokesWorker(Napi::Env env, const Napi::Promise::Deferred& deferred, PackedStrokes packed)
+        : Napi::AsyncWorker(env, "CanvasAddStrokes"), deferred(deferred), packed(std::move(packed)) {}
+    
+    void Execute() override {
+        strokes.appendPacked(packed.points.data(), packed.stride, packed.offsets.data(), packed.offsets.size() - 1,
+                             packed.colors.data(), packed.widths.data());
+        packed = PackedStrokes();
+    }
+    
+    void OnOK() override {
+        const size_t count = strokes.size();
+        CanvasCommand command;
+        command.type = CommandType::AddStrokes;
+        command.strokes = std::move(strokes);
+        deferred.Resolve(submitCommand(Env(), std::move(command), [count](Napi::Env env, CommandResult& result) {
+            VS_INFO(Addon, "✓ Added " << count << " strokes");
+            result.deferred.Resolve(Napi::Boolean::New(env, result.success));
+        }));
+    }
+    
+private:
+    Napi::Promise::Deferred deferred;
+    PackedStrokes packed;
+    StrokePool strokes;
+};
+
+static bool isTypedArray(const Napi::Value& value, napi_typedarray_type type) {
+    return value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == type;
+}
+
+template <typename T>
+static std::vector<T> copyTypedArray(const Napi::Value& value) {
+    Napi::TypedArrayOf<T> array = value.As<Napi::TypedArrayOf<T>>();
+    return std::vector<T>(array.Data(), array.Data() + array.ElementLength());
+}
+
+// Validates and copies addStrokes(points, offsets, colors, widths); throws
+// and returns false on bad input
+static bool packedStrokesArguments(const Napi::CallbackInfo& info, PackedStrokes& packed) {
+    Napi::Env env = info.Env();
+    
+    if (!isTypedArray(info[0], napi_float32_array) || !isTypedArray(info[1], napi_uint32_array)) {
+        Napi::TypeError::New(env, "Float32Array points and Uint32Array offsets expected").ThrowAsJavaScriptException();
+        return false;
+    }
+    if ((!info[2].IsUndefined() && !isTypedArray(info[2], napi_float32_array)) ||
+        (!info[3].IsUndefined() && !isTypedArray(info[3], napi_float32_array))) {
+        Napi::TypeError::New(env, "Colors and widths must be Float32Arrays").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    packed.offsets = copyTypedArray<uint32_t>(info[1]);
+    const std::vector<uint32_t>& offsets = packed.offsets;
+    const size_t strokeCount = offsets.empty() ? 0 : offsets.size() - 1;
+    const size_t pointCount = offsets.empty() ? 0 : offsets.back();
+    const size_t floatCount = info[0].As<Napi::Float32Array>().ElementLength();
+    
+    // Offsets start at 0 and every stroke has at least one point
+    bool validOffsets = !offsets.empty() && offsets[0] == 0;
+    for (size_t s = 0; validOffsets && s < strokeCount; ++s) {
+        validOffsets = offsets[s + 1] > offsets[s];
+    }
+    if (!validOffsets) {
+        Napi::RangeError::New(env, "Offsets must start at 0 and increase").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    // x, y and, optionally, pressure, tiltX, tiltY, timestamp per point
+    packed.stride = pointCount ? floatCount / pointCount : 2;
+    if (packed.stride < 2 || packed.stride > 6 || packed.stride * pointCount != floatCount) {
+        Napi::RangeError::New(env, "Points must hold 2 to 6 floats per point").ThrowAsJavaScriptException();
+        return false;
+    }
+    packed.points = copyTypedArray<float>(info[0]);
+    
+    // Values come from the copy, which JS can no longer change. A NaN point
+    // would leave its stroke unindexed, an enormous one unreachable
+    bool validPoints = true;
+    for (size_t i = 0; validPoints && i < packed.points.size(); ++i) {
+        float value = packed.points[i];
+        validPoints = std::isfinite(value) &&
+                      (i % packed.stride >= 2 || std::abs(value) <= MAX_IMPORT_COORDINATE);
+    }
+    if (!validPoints) {
+        Napi::RangeError::New(env, "Points must be finite, with x and y within 1e9 of the origin")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    if (info[2].IsUndefined()) {
+        packed.colors.assign(strokeCount * 3, 0.0f);
+    } else {
+        packed.colors = copyTypedArray<float>(info[2]);
+    }
+    if (info[3].IsUndefined()) {
+        packed.widths.assign(strokeCount, DEFAULT_IMPORT_WIDTH);
+    } else {
+        packed.widths = copyTypedArray<float>(info[3]);
+    }
+    if (packed.colors.size() != strokeCount * 3 || packed.widths.size() != strokeCount) {
+        Napi::RangeError::New(env, "Expected 3 colors and 1 width per stroke").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    bool validStyle = std::all_of(packed.colors.begin(), packed.colors.end(),
+                                  [](float channel) { return std::isfinite(channel); }) &&
+                      std::all_of(packed.widths.begin(), packed.widths.end(),
+                                  [](float width) { return width > 0.0f && width <= MAX_IMPORT_COORDINATE; });
+    if (!validStyle) {
+        Napi::RangeError::New(env, "Colors must be finite and widths positive, up to 1e9")
+            .ThrowAsJavaScriptException();
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// Stroke Data Export
+// ============================================================================
+//
+// Stroke data goes to JS as typed arrays over a snapshot's memory, which is
+// the canvas's own until it next changes: no copy and no serialization. Every
+// ArrayBuffer holds a reference to the snapshot, which stays alive until the
+// last of them is collected; while it does, the canvas's first edit copies
+// its arrays and leaves these to the snapshot.
+
+// Colors and bounds are exposed as runs of floats
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be three packed floats");
+static_assert(sizeof(BoundingBox) == 4 * sizeof(float), "BoundingBox must be four packed floats");
+static_assert(sizeof(StrokeEncoding) == sizeof(uint8_t), "StrokeEncoding must fit a Uint8Array");
+
+// ArrayBuffer over `bytes` bytes of the snapshot at `data`. Runtimes that
+// forbid external buffers (Electron's V8 memory cage) get a copy instead.
+static Napi::ArrayBuffer snapshotBuffer(Napi::Env env, const std::shared_ptr<const StrokePool>& snapshot,
+                                        const void* data, size_t bytes) {
+    if (bytes > 0) {
+        auto* pin = new std::shared_ptr<const StrokePool>(snapshot);
+        napi_value buffer;
+        napi_status status = napi_create_external_arraybuffer(
+            env, const_cast<void*>(data), bytes,
+            [](napi_env, void*, void* hint) { delete static_cast<std::shared_ptr<const StrokePool>*>(hint); },
+            pin, &buffer);
+        if (status == napi_ok) {
+            return Napi::ArrayBuffer(env, buffer);
+        }
+        delete pin;
+    }
+    
+    Napi::ArrayBuffer copy = Napi::ArrayBuffer::New(env, bytes);
+    if (bytes > 0) {
+        std::memcpy(copy.Data(), data, bytes);
+    }
+    return copy;
+}
+
+template <typename T>
+static Napi::TypedArrayOf<T> snapshotArray(Napi::Env env, const std::shared_ptr<const StrokePool>& snapshot,
+                                           const T* data, size_t count) {
+    Napi::ArrayBuffer buffer = snapshotBuffer(env, snapshot, data, count * sizeof(T));
+    return Napi::TypedArrayOf<T>::New(env, count, buffer, 0);
+}
+
+static Napi::Object strokeData(Napi::Env env, const std::shared_ptr<const StrokePool>& snapshot) {
+    const StrokePool& strokes = *snapshot;
+    const StrokePointArrays& points = strokes.getPointArrays();
+    const size_t strokeCount = strokes.size();
+    const size_t pointCount = points.size();
+    
+    Napi::Object data = Napi::Object::New(env);
+    data.Set("version", Napi::BigInt::New(env, strokes.getVersion()));
+    data.Set("strokeCount", Napi::Number::New(env, static_cast<double>(strokeCount)));
+    data.Set("pointCount", Napi::Number::New(env, static_cast<double>(pointCount)));
+    
+    // Point columns
+    data.Set("x", snapshotArray(env, snapshot, points.x.data(), pointCount));
+    data.Set("y", snapshotArray(env, snapshot, points.y.data(), pointCount));
+    data.Set("pressure", snapshotArray(env, snapshot, points.pressure.data(), pointCount));
+    data.Set("tiltX", snapshotArray(env, snapshot, points.tiltX.data(), pointCount));
+    data.Set("tiltY", snapshotArray(env, snapshot, points.tiltY.data(), pointCount));
+    data.Set("timestamp", snapshotArray(env, snapshot, points.timestamp.data(), pointCount));
+    
+    // Per stroke: point range, identity and style
+    data.Set("offsets", snapshotArray(env, snapshot, strokes.getOffsets().data(), strokeCount + 1));
+    data.Set("ids", snapshotArray(env, snapshot, strokes.getIds().data(), strokeCount));
+    data.Set("colors", snapshotArray(env, snapshot, reinterpret_cast<const float*>(strokes.getColors().data()),
+                                     strokeCount * 3));
+    data.Set("widths", snapshotArray(env, snapshot, strokes.getBaseWidths().data(), strokeCount));
+    data.Set("bounds", snapshotArray(env, snapshot, reinterpret_cast<const float*>(strokes.getAllBounds().data()),
+                                     strokeCount * 4));
+    data.Set("encodings", snapshotArray(env, snapshot,
+                                        reinterpret_cast<const uint8_t*>(strokes.getEncodings().data()),
+                                        strokeCount));
+    return data;
+}
+
 // ============================================================================
 // Helper Functions
 // ============================================================================
@@ -94,8 +550,9 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
                 
                 glm::vec3 color = g_toolWheel->getEffectiveColor();
                 float brushWidth = g_toolWheel->getBrushWidth();
+                StrokeInputFilter filter = g_toolWheel->getInputFilter(currentTool).scaled(1.0f / g_renderer->getViewScale());
                 
-                g_canvas->beginStroke(color, brushWidth);
+                g_canvas->beginStroke(color, brushWidth, filter);
                 
                 glm::vec2 worldPos = g_renderer->screenToWorld(mousePos);
                 StrokePoint point(worldPos, 1.0f, 0.0f, 0.0f, getCurrentTime());
@@ -116,6 +573,7 @@ void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
                 isDrawingLasso = false;
                 lassoPoints.clear();
             } else if (isMovingSelection) {
+                g_canvas->finishMovingSelection();
                 isMovingSelection = false;
             }
         }
@@ -234,7 +692,12 @@ Napi::Value Init(const Napi::CallbackInfo& info) {
     g_renderer = new VectorRenderer();
     g_toolWheel = new ToolWheel();
     
-    std::cout << "✓ Canvas initialized" << std::endl;
+    // Settles command promises; only keeps Node alive while some are pending
+    g_settleCommands = Napi::ThreadSafeFunction::New(
+        env, Napi::Function::New(env, [](const Napi::CallbackInfo&) {}), "CanvasCommands", 0, 1);
+    g_settleCommands.Unref(env);
+    
+    VS_INFO(Addon, "✓ Canvas initialized");
     return Napi::Boolean::New(env, true);
 }
 
@@ -258,7 +721,7 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
     // Run GLFW window in separate thread to avoid blocking Node.js event loop
     g_renderThread = new std::thread([]() {
         if (!glfwInit()) {
-            std::cerr << "Failed to initialize GLFW" << std::endl;
+            VS_ERROR(Addon, "Failed to initialize GLFW");
             return;
         }
         
@@ -273,7 +736,7 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
         
         g_window = glfwCreateWindow(1280, 720, "Infinite Canvas", nullptr, nullptr);
         if (!g_window) {
-            std::cerr << "Failed to create GLFW window" << std::endl;
+            VS_ERROR(Addon, "Failed to create GLFW window");
             glfwTerminate();
             return;
         }
@@ -289,7 +752,7 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
         glfwSetFramebufferSizeCallback(g_window, framebufferSizeCallback);
         
         if (!g_renderer->initialize(1280, 720)) {
-            std::cerr << "Failed to initialize renderer" << std::endl;
+            VS_ERROR(Addon, "Failed to initialize renderer");
             glfwTerminate();
             return;
         }
@@ -307,17 +770,22 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
         ImGui_ImplGlfw_InitForOpenGL(g_window, true);
         ImGui_ImplOpenGL3_Init("#version 330");
         
-        std::cout << "✓ Canvas window opened" << std::endl;
-        std::cout << "Controls:" << std::endl;
-        std::cout << "  Left Mouse: Draw" << std::endl;
-        std::cout << "  Middle/Right Mouse: Pan" << std::endl;
-        std::cout << "  Scroll: Zoom" << std::endl;
-        std::cout << "  Ctrl+Z: Undo" << std::endl;
-        std::cout << "  ESC: Close window" << std::endl;
+        VS_INFO(Addon, "✓ Canvas window opened");
+        VS_INFO(Addon, "Controls:");
+        VS_INFO(Addon, "  Left Mouse: Draw");
+        VS_INFO(Addon, "  Middle/Right Mouse: Pan");
+        VS_INFO(Addon, "  Scroll: Zoom");
+        VS_INFO(Addon, "  Ctrl+Z: Undo");
+        VS_INFO(Addon, "  ESC: Close window");
+        
+        // The canvas is ours until the loop ends
+        g_canvasOwner.lock();
+        g_renderLoopRunning = true;
         
         // Main render loop
         while (!glfwWindowShouldClose(g_window)) {
             glfwPollEvents();
+            drainCommands();
             
             // Start ImGui frame
             ImGui_ImplOpenGL3_NewFrame();
@@ -340,7 +808,12 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
             glfwSwapBuffers(g_window);
         }
         
-        std::cout << "✓ Canvas window closed" << std::endl;
+        // Commands queued before this point run here, later ones on the JS thread
+        g_renderLoopRunning = false;
+        drainCommands();
+        g_canvasOwner.unlock();
+        
+        VS_INFO(Addon, "✓ Canvas window closed");
         
         // Cleanup ImGui
         ImGui_ImplOpenGL3_Shutdown();
@@ -355,8 +828,8 @@ Napi::Value OpenWindow(const Napi::CallbackInfo& info) {
 }
 
 /**
- * Save drawing to file
- * JavaScript: canvas.saveDrawing('/path/to/file.mm')
+ * Save drawing to file, from a snapshot of the strokes
+ * JavaScript: await canvas.saveDrawing('/path/to/file.mm')
  */
 Napi::Value SaveDrawing(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -372,20 +845,25 @@ Napi::Value SaveDrawing(const Napi::CallbackInfo& info) {
     }
     
     std::string filepath = info[0].As<Napi::String>().Utf8Value();
-    bool success = g_canvas->saveToFile(filepath);
     
-    if (success) {
-        std::cout << "✓ Saved: " << filepath << std::endl;
-    } else {
-        std::cerr << "✗ Failed to save: " << filepath << std::endl;
-    }
-    
-    return Napi::Boolean::New(env, success);
+    CanvasCommand command;
+    command.type = CommandType::Snapshot;
+    return submitCommand(env, std::move(command), [filepath](Napi::Env env, CommandResult& result) {
+        bool success = Canvas::writeStrokes(*result.snapshot, filepath);
+        
+        if (success) {
+            VS_INFO(Addon, "✓ Saved: " << filepath);
+        } else {
+            VS_ERROR(Addon, "✗ Failed to save: " << filepath);
+        }
+        
+        result.deferred.Resolve(Napi::Boolean::New(env, success));
+    });
 }
 
 /**
- * Load drawing from file
- * JavaScript: canvas.loadDrawing('/path/to/file.mm')
+ * Load drawing from file; the file is read here and swapped in by the canvas owner
+ * JavaScript: await canvas.loadDrawing('/path/to/file.mm')
  */
 Napi::Value LoadDrawing(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -401,20 +879,23 @@ Napi::Value LoadDrawing(const Napi::CallbackInfo& info) {
     }
     
     std::string filepath = info[0].As<Napi::String>().Utf8Value();
-    bool success = g_canvas->loadFromFile(filepath);
     
-    if (success) {
-        std::cout << "✓ Loaded: " << filepath << std::endl;
-    } else {
-        std::cerr << "✗ Failed to load: " << filepath << std::endl;
+    CanvasCommand command;
+    command.type = CommandType::ReplaceStrokes;
+    if (!Canvas::readStrokes(filepath, command.strokes)) {
+        VS_ERROR(Addon, "✗ Failed to load: " << filepath);
+        return resolvedPromise(env, Napi::Boolean::New(env, false));
     }
     
-    return Napi::Boolean::New(env, success);
+    return submitCommand(env, std::move(command), [filepath](Napi::Env env, CommandResult& result) {
+        VS_INFO(Addon, "✓ Loaded: " << filepath);
+        result.deferred.Resolve(Napi::Boolean::New(env, result.success));
+    });
 }
 
 /**
  * Clear canvas
- * JavaScript: canvas.clear()
+ * JavaScript: await canvas.clear()
  */
 Napi::Value Clear(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -424,10 +905,132 @@ Napi::Value Clear(const Napi::CallbackInfo& info) {
         return env.Null();
     }
     
-    g_canvas->clear();
-    std::cout << "✓ Canvas cleared" << std::endl;
+    CanvasCommand command;
+    command.type = CommandType::Clear;
+    return submitCommand(env, std::move(command), [](Napi::Env env, CommandResult& result) {
+        VS_INFO(Addon, "✓ Canvas cleared");
+        result.deferred.Resolve(Napi::Boolean::New(env, result.success));
+    });
+}
+
+// Path and optional progress callback of the async file functions
+static bool fileArguments(const Napi::CallbackInfo& info, std::string& filepath) {
+    Napi::Env env = info.Env();
+    
+    if (g_canvas == nullptr) {
+        Napi::Error::New(env, "Canvas not initialized").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    if (info.Length() < 1 || !info[0].IsString()) {
+        Napi::TypeError::New(env, "String expected").ThrowAsJavaScriptException();
+        return false;
+    }
     
-    return Napi::Boolean::New(env, true);
+    if (info.Length() >= 2 && !info[1].IsFunction() && !info[1].IsUndefined()) {
+        Napi::TypeError::New(env, "Progress callback must be a function").ThrowAsJavaScriptException();
+        return false;
+    }
+    
+    filepath = info[0].As<Napi::String>().Utf8Value();
+    return true;
+}
+
+/**
+ * Save drawing to file on a worker thread, from a snapshot of the strokes
+ * JavaScript: await canvas.saveDrawingAsync('/path/to/file.mm', fraction => {...})
+ */
+Napi::Value SaveDrawingAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    std::string filepath;
+    if (!fileArguments(info, filepath)) {
+        return env.Null();
+    }
+    
+    // The worker is created once the snapshot exists; keep the callback alive until then
+    std::shared_ptr<Napi::FunctionReference> onProgress;
+    if (info.Length() >= 2 && info[1].IsFunction()) {
+        onProgress = std::make_shared<Napi::FunctionReference>(Napi::Persistent(info[1].As<Napi::Function>()));
+    }
+    
+    CanvasCommand command;
+    command.type = CommandType::Snapshot;
+    return submitCommand(env, std::move(command), [filepath, onProgress](Napi::Env env, CommandResult& result) {
+        Napi::Value callback = onProgress ? onProgress->Value() : env.Undefined();
+        (new SaveWorker(env, result.deferred, filepath, callback, result.snapshot))->Queue();
+    });
+}
+
+/**
+ * Load drawing from file on a worker thread; the strokes are swapped in at
+ * the next frame boundary
+ * JavaScript: await canvas.loadDrawingAsync('/path/to/file.mm', fraction => {...})
+ */
+Napi::Value LoadDrawingAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    std::string filepath;
+    if (!fileArguments(info, filepath)) {
+        return env.Null();
+    }
+    
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    (new LoadWorker(env, deferred, filepath, info[1]))->Queue();
+    return deferred.Promise();
+}
+
+/**
+ * Append many strokes at once, as one undo step. Stroke i owns points
+ * [offsets[i], offsets[i + 1]); each point is 2 to 6 floats (x, y, pressure,
+ * tiltX, tiltY, timestamp), the same count for all. colors (r g b per
+ * stroke, default black) and widths (default 2) are optional.
+ * JavaScript: await canvas.addStrokes(points, offsets, colors, widths)
+ */
+Napi::Value AddStrokes(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (g_canvas == nullptr) {
+        Napi::Error::New(env, "Canvas not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    PackedStrokes packed;
+    if (!packedStrokesArguments(info, packed)) {
+        return env.Null();
+    }
+    if (packed.offsets.size() < 2) {
+        return resolvedPromise(env, Napi::Boolean::New(env, true));
+    }
+    
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    (new AddStrokesWorker(env, deferred, std::move(packed)))->Queue();
+    return deferred.Promise();
+}
+
+/**
+ * Committed strokes as typed arrays over a snapshot, which shares the
+ * canvas's arrays (no copy until the canvas next changes). The arrays are
+ * shared with other readers of the snapshot and must not be written.
+ * JavaScript: const data = await canvas.getStrokeData()
+ *   data.x, y, pressure, tiltX, tiltY, timestamp: Float32Array, one entry per point
+ *   data.offsets: Uint32Array, stroke i owns points [offsets[i], offsets[i + 1])
+ *   data.ids: BigUint64Array; data.widths: Float32Array; data.encodings: Uint8Array (1 = cubic)
+ *   data.colors: Float32Array, r g b per stroke; data.bounds: Float32Array, minX minY maxX maxY per stroke
+ */
+Napi::Value GetStrokeData(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    if (g_canvas == nullptr) {
+        Napi::Error::New(env, "Canvas not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+    
+    CanvasCommand command;
+    command.type = CommandType::Snapshot;
+    return submitCommand(env, std::move(command), [](Napi::Env env, CommandResult& result) {
+        result.deferred.Resolve(strokeData(env, result.snapshot));
+    });
 }
 
 /**
@@ -452,6 +1055,14 @@ Napi::Object InitModule(Napi::Env env, Napi::Object exports) {
                 Napi::Function::New(env, SaveDrawing));
     exports.Set(Napi::String::New(env, "loadDrawing"),
                 Napi::Function::New(env, LoadDrawing));
+    exports.Set(Napi::String::New(env, "saveDrawingAsync"),
+                Napi::Function::New(env, SaveDrawingAsync));
+    exports.Set(Napi::String::New(env, "loadDrawingAsync"),
+                Napi::Function::New(env, LoadDrawingAsync));
+    exports.Set(Napi::String::New(env, "addStrokes"),
+                Napi::Function::New(env, AddStrokes));
+    exports.Set(Napi::String::New(env, "getStrokeData"),
+                Napi::Function::New(env, GetStrokeData));
     exports.Set(Napi::String::New(env, "clear"),
                 Napi::Function::New(env, Clear));
     exports.Set(Napi::String::New(env, "isWindowOpen"),